@@ -19,7 +19,7 @@ SDL?=1
 # In common usage.
 ifdef LINUX
 libs+=-lrt
-passthru_opts+=NOTERMIOS
+passthru_opts+=NOTERMIOS NOEPOLL
 endif
 
 # Tested by Steel, as of release 2.2.8.
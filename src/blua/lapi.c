@@ -855,7 +855,23 @@ LUA_API int lua_load (lua_State *L, lua_Reader reader, void *data,
   lua_lock(L);
   if (!chunkname) chunkname = "?";
   luaZ_init(L, &z, reader, data);
-  status = luaD_protectedparser(L, &z, chunkname);
+  status = luaD_protectedparser(L, &z, chunkname, 0);
+  lua_unlock(L);
+  return status;
+}
+
+
+/* SRB2: like lua_load, but also accepts precompiled chunks
+   regardless of LUA_ALLOW_BYTECODE. Only for bytecode the engine
+   produced itself with lua_dump, never for anything from an addon. */
+LUA_API int lua_loadtrusted (lua_State *L, lua_Reader reader, void *data,
+                      const char *chunkname) {
+  ZIO z;
+  int status;
+  lua_lock(L);
+  if (!chunkname) chunkname = "?";
+  luaZ_init(L, &z, reader, data);
+  status = luaD_protectedparser(L, &z, chunkname, 1);
   lua_unlock(L);
   return status;
 }
@@ -941,6 +957,10 @@ LUA_API int lua_gc (lua_State *L, int what, int data) {
       g->gcstepmul = data;
       break;
     }
+    case LUA_GCSETTHRESHOLD: {
+      g->GCthreshold = cast(lu_mem, data) << 10;
+      break;
+    }
     default: res = -1;  /* invalid option */
   }
   lua_unlock(L);
@@ -63,6 +63,20 @@ static boolean CV_Immutable(const consvar_t *var);
 static consvar_t *consvar_vars; // list of registered console variables
 static UINT16     consvar_number_of_netids = 0;
 
+// Commands, aliases and variables are also chained into case-insensitive
+// hash tables for lookup. The linked lists above keep registration order
+// for listing and tab-completion.
+#define COM_HASHSIZE 1024 // must be a power of two
+
+static UINT32 COM_NameHash(const char *name)
+{
+	return quickncasehash(name, strlen(name)) & (COM_HASHSIZE - 1);
+}
+
+static consvar_t *consvar_hash[COM_HASHSIZE];
+static consvar_t **consvar_netvars; // netid -> variable, 1-based
+static size_t consvar_netvars_size;
+
 #ifdef OLD22DEMOCOMPAT
 static old_demo_var_t *consvar_old_demo_vars;
 #endif
@@ -100,11 +114,13 @@ static INT32 com_wait; // one command per frame (for cmd sequences)
 typedef struct cmdalias_s
 {
 	struct cmdalias_s *next;
+	struct cmdalias_s *hashnext;
 	char *name;
 	char *value; // the command string to replace the alias
 } cmdalias_t;
 
 static cmdalias_t *com_alias; // aliases list
+static cmdalias_t *com_alias_hash[COM_HASHSIZE];
 
 // =========================================================================
 //                            COMMAND BUFFER
@@ -313,11 +329,41 @@ typedef struct xcommand_s
 {
 	const char *name;
 	struct xcommand_s *next;
+	struct xcommand_s *hashnext;
 	com_func_t function;
 	com_flags_t flags;
 } xcommand_t;
 
 static xcommand_t *com_commands = NULL; // current commands
+static xcommand_t *com_commands_hash[COM_HASHSIZE];
+
+/** Finds a console command by name.
+  *
+  * \param name Name of the command, case insensitive.
+  * \return The command, or NULL if it doesn't exist.
+  */
+static xcommand_t *COM_FindCommand(const char *name)
+{
+	xcommand_t *cmd;
+
+	for (cmd = com_commands_hash[COM_NameHash(name)]; cmd; cmd = cmd->hashnext)
+		if (!stricmp(name, cmd->name)) //case insensitive now that we have lower and uppercase!
+			return cmd;
+
+	return NULL;
+}
+
+/** Links a new command into the command list and hash table.
+  */
+static void COM_LinkCommand(xcommand_t *cmd)
+{
+	UINT32 hash = COM_NameHash(cmd->name);
+
+	cmd->next = com_commands;
+	com_commands = cmd;
+	cmd->hashnext = com_commands_hash[hash];
+	com_commands_hash[hash] = cmd;
+}
 
 #define MAX_ARGS 80
 static size_t com_argc;
@@ -495,27 +541,24 @@ void COM_AddCommand(const char *name, com_func_t func, com_flags_t flags)
 	}
 
 	// fail if the command already exists
-	for (cmd = com_commands; cmd; cmd = cmd->next)
+	cmd = COM_FindCommand(name);
+	if (cmd)
 	{
-		if (!stricmp(name, cmd->name)) //case insensitive now that we have lower and uppercase!
-		{
-			// don't I_Error for Lua commands
-			// Lua commands can replace game commands, and they have priority.
-			// BUT, if for some reason we screwed up and made two console commands with the same name,
-			// it's good to have this here so we find out.
-			if (cmd->function != COM_Lua_f)
-				I_Error("Command %s already exists\n", name);
+		// don't I_Error for Lua commands
+		// Lua commands can replace game commands, and they have priority.
+		// BUT, if for some reason we screwed up and made two console commands with the same name,
+		// it's good to have this here so we find out.
+		if (cmd->function != COM_Lua_f)
+			I_Error("Command %s already exists\n", name);
 
-			return;
-		}
+		return;
 	}
 
 	cmd = ZZ_Alloc(sizeof *cmd);
 	cmd->name = name;
 	cmd->function = func;
 	cmd->flags = flags;
-	cmd->next = com_commands;
-	com_commands = cmd;
+	COM_LinkCommand(cmd);
 }
 
 /** Adds a console command for Lua.
@@ -532,14 +575,12 @@ int COM_AddLuaCommand(const char *name)
 		return -1;
 
 	// command already exists
-	for (cmd = com_commands; cmd; cmd = cmd->next)
+	cmd = COM_FindCommand(name);
+	if (cmd)
 	{
-		if (!stricmp(name, cmd->name)) //case insensitive now that we have lower and uppercase!
-		{
-			// replace the built in command.
-			cmd->function = COM_Lua_f;
-			return 1;
-		}
+		// replace the built in command.
+		cmd->function = COM_Lua_f;
+		return 1;
 	}
 
 	// Add a new command.
@@ -547,8 +588,7 @@ int COM_AddLuaCommand(const char *name)
 	cmd->name = name;
 	cmd->function = COM_Lua_f;
 	cmd->flags = COM_LUA;
-	cmd->next = com_commands;
-	com_commands = cmd;
+	COM_LinkCommand(cmd);
 	return 0;
 }
 
@@ -559,13 +599,7 @@ int COM_AddLuaCommand(const char *name)
   */
 static boolean COM_Exists(const char *com_name)
 {
-	xcommand_t *cmd;
-
-	for (cmd = com_commands; cmd; cmd = cmd->next)
-		if (!stricmp(com_name, cmd->name))
-			return true;
-
-	return false;
+	return COM_FindCommand(com_name) != NULL;
 }
 
 /** Does command completion for the console.
@@ -638,23 +672,21 @@ static void COM_ExecuteString(char *ptext)
 		return; // no tokens
 
 	// check functions
-	for (cmd = com_commands; cmd; cmd = cmd->next)
+	cmd = COM_FindCommand(com_argv[0]);
+	if (cmd)
 	{
-		if (!stricmp(com_argv[0], cmd->name)) //case insensitive now that we have lower and uppercase!
+		if ((com_flags & COM_LUA) && !(cmd->flags & COM_LUA))
 		{
-			if ((com_flags & COM_LUA) && !(cmd->flags & COM_LUA))
-			{
-				CONS_Alert(CONS_WARNING, "Command '%s' cannot be run from Lua.\n", cmd->name);
-				return;
-			}
-
-			cmd->function();
+			CONS_Alert(CONS_WARNING, "Command '%s' cannot be run from Lua.\n", cmd->name);
 			return;
 		}
+
+		cmd->function();
+		return;
 	}
 
 	// check aliases
-	for (a = com_alias; a; a = a->next)
+	for (a = com_alias_hash[COM_NameHash(com_argv[0])]; a; a = a->hashnext)
 	{
 		if (!stricmp(com_argv[0], a->name))
 		{
@@ -695,9 +727,10 @@ static void print_alias(void)
 static void add_alias(char *newname, char *newcmd)
 {
 	cmdalias_t *a;
+	UINT32 hash = COM_NameHash(newname);
 
 	// Check for existing aliases first
-	for (a = com_alias; a; a = a->next)
+	for (a = com_alias_hash[hash]; a; a = a->hashnext)
 	{
 		if (!stricmp(newname, a->name))
 		{
@@ -711,6 +744,8 @@ static void add_alias(char *newname, char *newcmd)
 	a = ZZ_Alloc(sizeof *a);
 	a->next = com_alias;
 	com_alias = a;
+	a->hashnext = com_alias_hash[hash];
+	com_alias_hash[hash] = a;
 
 	a->name = newname;
 	a->value = newcmd;
@@ -1225,7 +1260,7 @@ consvar_t *CV_FindVar(const char *name)
 {
 	consvar_t *cvar;
 
-	for (cvar = consvar_vars; cvar; cvar = cvar->next)
+	for (cvar = consvar_hash[COM_NameHash(name)]; cvar; cvar = cvar->hashnext)
 		if (!stricmp(name,cvar->name))
 			return cvar;
 
@@ -1291,16 +1326,10 @@ static old_demo_var_t *CV_FindOldDemoVar(UINT16 chk)
   */
 static consvar_t *CV_FindNetVar(UINT16 netid)
 {
-	consvar_t *cvar;
-
-	if (netid > consvar_number_of_netids)
+	if (netid > consvar_number_of_netids || netid >= consvar_netvars_size)
 		return NULL;
 
-	for (cvar = consvar_vars; cvar; cvar = cvar->next)
-		if (cvar->netid == netid)
-			return cvar;
-
-	return NULL;
+	return consvar_netvars[netid];
 }
 
 static void Setvalue(consvar_t *var, const char *valstr, boolean stealth);
@@ -1368,8 +1397,29 @@ void CV_RegisterVar(consvar_t *variable)
 	// link the variable in
 	if (!(variable->flags & CV_HIDEN))
 	{
+		UINT32 hash = COM_NameHash(variable->name);
+
 		variable->next = consvar_vars;
 		consvar_vars = variable;
+		variable->hashnext = consvar_hash[hash];
+		consvar_hash[hash] = variable;
+
+		if (variable->flags & CV_NETVAR)
+		{
+			if (variable->netid >= consvar_netvars_size)
+			{
+				size_t newsize = max(consvar_netvars_size * 2, 256);
+
+				while (newsize <= variable->netid)
+					newsize *= 2;
+
+				consvar_netvars = Z_Realloc(consvar_netvars, newsize * sizeof *consvar_netvars, PU_STATIC, NULL);
+				memset(consvar_netvars + consvar_netvars_size, 0, (newsize - consvar_netvars_size) * sizeof *consvar_netvars);
+				consvar_netvars_size = newsize;
+			}
+
+			consvar_netvars[variable->netid] = variable;
+		}
 	}
 	variable->string = variable->zstring = NULL;
 	memset(&variable->revert, 0, sizeof variable->revert);
@@ -1769,6 +1819,27 @@ static void Got_NetVar(UINT8 **p, INT32 playernum)
 		Setvalue(cvar, svalue, stealth);
 }
 
+/** Works out how many bytes CV_SaveVars will write, so the caller can
+  * make room for them first.
+  *
+  * \param in_demo Whether the variables are saved by name, for demos.
+  * \return The size of the saved variables, in bytes.
+  */
+size_t CV_SavedVarsSize(boolean in_demo)
+{
+	consvar_t *cvar;
+	size_t size = sizeof (UINT16);
+
+	for (cvar = consvar_vars; cvar; cvar = cvar->next)
+		if ((cvar->flags & CV_NETVAR) && !CV_IsSetToDefault(cvar))
+		{
+			size += in_demo ? strlen(cvar->name) + 1 : sizeof (UINT16);
+			size += strlen(cvar->string) + 1 + sizeof (UINT8);
+		}
+
+	return size;
+}
+
 void CV_SaveVars(UINT8 **p, boolean in_demo)
 {
 	consvar_t *cvar;
@@ -0,0 +1,7 @@
+
+// Do not edit!  This file was autogenerated
+// by the ../comptime.sh script with git
+//
+const char* compbranch = "master";
+const char* comprevision = "6c94e8b1";
+const char* compnote = "[user-046] fix: uncount zone-purged texture blocks and mipmaps";
@@ -47,6 +47,7 @@
 #include "lua_libs.h"
 #include "md5.h"
 #include "m_perfstats.h"
+#include "d_soaktest.h"
 
 // aaaaaa
 #include "i_joy.h"
@@ -121,6 +122,18 @@ UINT8 hu_redownloadinggamestate = 0;
 boolean hu_stopped = false;
 
 consvar_t cv_dedicatedidletime = CVAR_INIT ("dedicatedidletime", "10", CV_SAVE, CV_Unsigned, NULL);
+consvar_t cv_dedicatedeventloop = CVAR_INIT ("dedicatedeventloop", "On", CV_SAVE, CV_OnOff, NULL);
+
+// Where a dedicated server's time went, for the "serverload" command.
+// The totals roll over into the last* fields once a second has passed.
+static struct
+{
+	precise_t lastwake; // when NetWaitForPackets last returned
+	precise_t busy, idle;
+	UINT32 wakeups;
+	precise_t lastbusy, lastidle;
+	UINT32 lastwakeups;
+} serverload;
 
 UINT8 adminpassmd5[16];
 boolean adminpasswordset = false;
@@ -1548,7 +1561,14 @@ static boolean SV_SendServerConfig(INT32 node)
 }
 
 #ifndef NONET
-#define SAVEGAMESIZE (768*1024)
+// The gamestate is written and compressed in chunks of this size.
+// Sent as: UINT32 uncompressed size of the whole gamestate, then
+// for each chunk, UINT32 uncompressed size, UINT32 compressed size
+// (0 if stored uncompressed), and the chunk data.
+#define SAVEGAMECHUNKSIZE (64*1024)
+
+static UINT8 *savesendbuffer;
+static size_t savesendlength, savesendsize;
 
 static boolean SV_ResendingSavegameToAnyone(void)
 {
@@ -1560,68 +1580,65 @@ static boolean SV_ResendingSavegameToAnyone(void)
 	return false;
 }
 
-static void SV_SendSaveGame(INT32 node, boolean resending)
+// Compresses a chunk of the gamestate into savesendbuffer
+static void SV_CompressSaveGameChunk(const UINT8 *data, size_t length)
 {
-	size_t length, compressedlen;
-	UINT8 *savebuffer;
-	UINT8 *compressedsave;
-	UINT8 *buffertosend;
+	size_t compressedlen;
+	UINT8 *p;
 
-	// first save it in a malloced buffer
-	savebuffer = (UINT8 *)malloc(SAVEGAMESIZE);
-	if (!savebuffer)
+	// Worst case: the chunk doesn't compress and is stored as is
+	if (savesendlength + 2*sizeof(UINT32) + length > savesendsize)
 	{
-		CONS_Alert(CONS_ERROR, M_GetText("No more free memory for savegame\n"));
-		return;
+		savesendsize = (savesendlength + 2*sizeof(UINT32) + length) * 2;
+		savesendbuffer = realloc(savesendbuffer, savesendsize);
+		if (!savesendbuffer)
+			I_Error("No more free memory for savegame");
 	}
 
-	// Leave room for the uncompressed length.
-	save_p = savebuffer + sizeof(UINT32);
-
-	P_SaveNetGame(resending);
+	p = savesendbuffer + savesendlength;
+	WRITEUINT32(p, length);
 
-	length = save_p - savebuffer;
-	if (length > SAVEGAMESIZE)
+	// Only worth it if the compressed chunk is smaller
+	compressedlen = lzf_compress(data, length, p + sizeof(UINT32), length - 1);
+	if (compressedlen)
 	{
-		free(savebuffer);
-		save_p = NULL;
-		I_Error("Savegame buffer overrun");
+		WRITEUINT32(p, compressedlen);
+		p += compressedlen;
 	}
-
-	// Allocate space for compressed save: one byte fewer than for the
-	// uncompressed data to ensure that the compression is worthwhile.
-	compressedsave = malloc(length - 1);
-	if (!compressedsave)
+	else
 	{
-		CONS_Alert(CONS_ERROR, M_GetText("No more free memory for savegame\n"));
-		return;
+		WRITEUINT32(p, 0);
+		WRITEMEM(p, data, length);
 	}
 
-	// Attempt to compress it.
-	if((compressedlen = lzf_compress(savebuffer + sizeof(UINT32), length - sizeof(UINT32), compressedsave + sizeof(UINT32), length - sizeof(UINT32) - 1)))
-	{
-		// Compressing succeeded; send compressed data
+	savesendlength = p - savesendbuffer;
+}
 
-		free(savebuffer);
+static void SV_SendSaveGame(INT32 node, boolean resending)
+{
+	size_t length;
+	UINT8 *p;
 
-		// State that we're compressed.
-		buffertosend = compressedsave;
-		WRITEUINT32(compressedsave, length - sizeof(UINT32));
-		length = compressedlen + sizeof(UINT32);
-	}
-	else
+	// Leave room for the uncompressed length
+	savesendsize = SAVEGAMECHUNKSIZE;
+	savesendbuffer = malloc(savesendsize);
+	if (!savesendbuffer)
 	{
-		// Compression failed to make it smaller; send original
+		CONS_Alert(CONS_ERROR, M_GetText("No more free memory for savegame\n"));
+		return;
+	}
+	savesendlength = sizeof(UINT32);
 
-		free(compressedsave);
+	P_SaveBufferAlloc(SAVEGAMECHUNKSIZE, SV_CompressSaveGameChunk);
+	P_SaveNetGame(resending);
+	P_SaveBufferFinish(&length);
 
-		// State that we're not compressed
-		buffertosend = savebuffer;
-		WRITEUINT32(savebuffer, 0);
-	}
+	p = savesendbuffer;
+	WRITEUINT32(p, length);
 
-	AddRamToSendQueue(node, buffertosend, length, SF_RAM, 0);
-	save_p = NULL;
+	AddRamToSendQueue(node, savesendbuffer, savesendlength, SF_RAM, 0);
+	length = savesendlength;
+	savesendbuffer = NULL;
 
 	// Remember when we started sending the savegame so we can handle timeouts
 	sendingsavegame[node] = true;
@@ -1632,10 +1649,20 @@ static void SV_SendSaveGame(INT32 node, boolean resending)
 #define TMPSAVENAME "badmath.sav"
 static consvar_t cv_dumpconsistency = CVAR_INIT ("dumpconsistency", "Off", CV_SAVE|CV_NETVAR, CV_OnOff, NULL);
 
+static FILE *savedgamefile;
+
+static void SV_WriteSavedGameChunk(const UINT8 *data, size_t length)
+{
+	if (savedgamefile && fwrite(data, 1, length, savedgamefile) != length)
+	{
+		fclose(savedgamefile);
+		savedgamefile = NULL;
+	}
+}
+
 static void SV_SavedGame(void)
 {
 	size_t length;
-	UINT8 *savebuffer;
 	char tmpsave[256];
 
 	if (!cv_dumpconsistency.value)
@@ -1643,30 +1670,21 @@ static void SV_SavedGame(void)
 
 	sprintf(tmpsave, "%s" PATHSEP TMPSAVENAME, srb2home);
 
-	// first save it in a malloced buffer
-	save_p = savebuffer = (UINT8 *)malloc(SAVEGAMESIZE);
-	if (!save_p)
+	// Stream it straight to the file
+	savedgamefile = fopen(tmpsave, "wb");
+	if (!savedgamefile)
 	{
-		CONS_Alert(CONS_ERROR, M_GetText("No more free memory for savegame\n"));
+		CONS_Printf(M_GetText("Didn't save %s for netgame"), tmpsave);
 		return;
 	}
 
+	P_SaveBufferAlloc(SAVEGAMECHUNKSIZE, SV_WriteSavedGameChunk);
 	P_SaveNetGame(false);
+	P_SaveBufferFinish(&length);
 
-	length = save_p - savebuffer;
-	if (length > SAVEGAMESIZE)
-	{
-		free(savebuffer);
-		save_p = NULL;
-		I_Error("Savegame buffer overrun");
-	}
-
-	// then save it!
-	if (!FIL_WriteFile(tmpsave, savebuffer, length))
+	if (!savedgamefile || fclose(savedgamefile))
 		CONS_Printf(M_GetText("Didn't save %s for netgame"), tmpsave);
-
-	free(savebuffer);
-	save_p = NULL;
+	savedgamefile = NULL;
 }
 
 #undef  TMPSAVENAME
@@ -1693,14 +1711,49 @@ static void CL_LoadReceivedSavegame(boolean reloading)
 		return;
 	}
 
-	save_p = savebuffer;
-
-	// Decompress saved game if necessary.
-	decompressedlen = READUINT32(save_p);
-	if(decompressedlen > 0)
+	// Decompress the saved game, chunk by chunk
 	{
-		UINT8 *decompressedbuffer = Z_Malloc(decompressedlen, PU_STATIC, NULL);
-		lzf_decompress(save_p, length - sizeof(UINT32), decompressedbuffer, decompressedlen);
+		UINT8 *p = savebuffer, *end = savebuffer + length;
+		UINT8 *decompressedbuffer, *dest;
+
+		if (length < sizeof(UINT32))
+			I_Error("Savegame sent is corrupt");
+
+		decompressedlen = READUINT32(p);
+		dest = decompressedbuffer = Z_Malloc(decompressedlen, PU_STATIC, NULL);
+
+		while (p < end)
+		{
+			size_t chunklen, compressedlen;
+
+			if (end - p < (ptrdiff_t)(2*sizeof(UINT32)))
+				I_Error("Savegame sent is corrupt");
+
+			chunklen = READUINT32(p);
+			compressedlen = READUINT32(p);
+
+			if (chunklen > (size_t)(decompressedbuffer + decompressedlen - dest)
+				|| (compressedlen ? compressedlen : chunklen) > (size_t)(end - p))
+				I_Error("Savegame sent is corrupt");
+
+			if (compressedlen)
+			{
+				if (lzf_decompress(p, compressedlen, dest, chunklen) != chunklen)
+					I_Error("Savegame sent is corrupt");
+				p += compressedlen;
+			}
+			else
+			{
+				M_Memcpy(dest, p, chunklen);
+				p += chunklen;
+			}
+
+			dest += chunklen;
+		}
+
+		if (dest != decompressedbuffer + decompressedlen)
+			I_Error("Savegame sent is corrupt");
+
 		Z_Free(savebuffer);
 		save_p = savebuffer = decompressedbuffer;
 	}
@@ -3112,6 +3165,24 @@ static void Command_Nodes(void)
 	}
 }
 
+static void Command_ServerLoad(void)
+{
+	const precise_t precision = I_GetPrecisePrecision();
+	const precise_t total = serverload.lastbusy + serverload.lastidle;
+
+	if (!total)
+	{
+		CONS_Printf(M_GetText("No load has been recorded yet. This needs a dedicated server with dedicatedeventloop on.\n"));
+		return;
+	}
+
+	CONS_Printf(M_GetText("Last second: %u us busy, %u us idle (%u%% load), woken %u times by packets\n"),
+		(UINT32)(serverload.lastbusy * 1000000 / precision),
+		(UINT32)(serverload.lastidle * 1000000 / precision),
+		(UINT32)(serverload.lastbusy * 100 / total),
+		serverload.lastwakeups);
+}
+
 static void Command_Ban(void)
 {
 	if (COM_Argc() < 2)
@@ -3556,6 +3627,7 @@ void D_ClientServerInit(void)
 	COM_AddCommand("connect", Command_connect, COM_LUA);
 	COM_AddCommand("nodes", Command_Nodes, COM_LUA);
 	COM_AddCommand("resendgamestate", Command_ResendGamestate, COM_LUA);
+	COM_AddCommand("serverload", Command_ServerLoad, COM_LUA);
 #ifdef PACKETDROP
 	COM_AddCommand("drop", Command_Drop, COM_LUA);
 	COM_AddCommand("droprate", Command_Droprate, COM_LUA);
@@ -4615,6 +4687,8 @@ static void HandlePacketFromPlayer(SINT8 node)
 #endif
 				&& !resendingsavegame[node] && savegameresendcooldown[node] <= I_GetTime())
 			{
+				netnodestats[node].synchfailures++;
+
 				if (cv_resynchattempts.value)
 				{
 					// Tell the client we are about to resend them the gamestate
@@ -4925,6 +4999,7 @@ static void GetPackets(void)
 {
 	SINT8 node; // The packet sender
 
+	PS_TRACE_BEGIN("GetPackets");
 	player_joining = false;
 
 	while (HGetPacket())
@@ -4968,6 +5043,7 @@ static void GetPackets(void)
 		else
 			HandlePacketFromAwayNode(node);
 	}
+	PS_TRACE_END("GetPackets");
 }
 
 //
@@ -5302,6 +5378,8 @@ static void Local_Maketic(INT32 realtics)
 	G_BuildTiccmd(&localcmds, realtics, 1);
 	if (splitscreen || botingame)
 		G_BuildTiccmd(&localcmds2, realtics, 2);
+	if (soaktest && !dedicated)
+		D_SoakTestBuildTiccmd(&localcmds);
 
 	localcmds.angleturn |= TICCMD_RECEIVED;
 	localcmds2.angleturn |= TICCMD_RECEIVED;
@@ -5421,17 +5499,23 @@ boolean TryRunTics(tic_t realtics)
 			while (neededtic > gametic)
 			{
 				boolean update_stats = !(paused || P_AutoPause());
+				precise_t soakstart = soaktest ? I_GetPreciseTime() : 0;
 
 				DEBFILE(va("============ Running tic %d (local %d)\n", gametic, localgametic));
 
 				if (update_stats)
 					PS_START_TIMING(ps_tictime);
 
+				PS_TRACE_BEGIN("G_Ticker");
 				G_Ticker((gametic % NEWTICRATERATIO) == 0);
 				ExtraDataTicker();
+				PS_TRACE_END("G_Ticker");
 				gametic++;
 				consistancy[gametic%BACKUPTICS] = Consistancy();
 
+				if (soaktest && server)
+					D_SoakTestTicker(I_GetPreciseTime() - soakstart);
+
 				if (update_stats)
 				{
 					PS_STOP_TIMING(ps_tictime);
@@ -5608,6 +5692,60 @@ void NetKeepAlive(void)
 	FileSendTicker();
 }
 
+/** Waits for the next frame by blocking on the network sockets, handling
+  * packets as soon as they arrive instead of sleeping through them.
+  * Time spent waiting is counted as idle for the "serverload" command,
+  * everything else as busy.
+  *
+  * \param until When the wait should end, from I_GetPreciseTime.
+  * \return false if waiting on the network is not possible, in which case
+  *         the caller should sleep by other means.
+  */
+boolean NetWaitForPackets(precise_t until)
+{
+	const precise_t precision = I_GetPrecisePrecision();
+	precise_t now;
+
+	if (!dedicated || !cv_dedicatedeventloop.value || !I_NetWaitForPacket)
+		return false;
+
+	now = I_GetPreciseTime();
+	if (serverload.lastwake && now - serverload.lastwake < precision)
+		serverload.busy += now - serverload.lastwake;
+
+	while ((INT64)(until - now) > 0)
+	{
+		precise_t start = now;
+		const boolean ready = I_NetWaitForPacket((UINT32)((until - now) * 1000000 / precision));
+
+		now = I_GetPreciseTime();
+		serverload.idle += now - start;
+
+		if (ready)
+		{
+			serverload.wakeups++;
+			GetPackets();
+
+			start = now;
+			now = I_GetPreciseTime();
+			serverload.busy += now - start;
+		}
+	}
+
+	serverload.lastwake = now;
+
+	if (serverload.busy + serverload.idle >= precision)
+	{
+		serverload.lastbusy = serverload.busy;
+		serverload.lastidle = serverload.idle;
+		serverload.lastwakeups = serverload.wakeups;
+		serverload.busy = serverload.idle = 0;
+		serverload.wakeups = 0;
+	}
+
+	return true;
+}
+
 void NetUpdate(void)
 {
 	static tic_t resptime = 0;
@@ -5621,6 +5759,8 @@ void NetUpdate(void)
 	if (realtics <= 0) // nothing new to update
 		return;
 
+	PS_TRACE_BEGIN("NetUpdate");
+
 	if (realtics > 5)
 	{
 		if (server)
@@ -5779,6 +5919,7 @@ void NetUpdate(void)
 	}
 
 	FileSendTicker();
+	PS_TRACE_END("NetUpdate");
 }
 
 /** Returns the number of players playing.
@@ -30,7 +30,7 @@ packet versions.
 If you change the struct or the meaning of a field
 therein, increment this number.
 */
-#define PACKETVERSION 4
+#define PACKETVERSION 5
 
 // Network play related stuff.
 // There is a data struct that stores network
@@ -401,6 +401,7 @@ extern consvar_t cv_netticbuffer, cv_allownewplayer, cv_joinnextround, cv_maxpla
 extern consvar_t cv_resynchattempts, cv_blamecfail;
 extern consvar_t cv_maxsend, cv_noticedownload, cv_downloadspeed;
 extern consvar_t cv_dedicatedidletime;
+extern consvar_t cv_dedicatedeventloop;
 
 // Used in d_net, the only dependence
 tic_t ExpandTics(INT32 low, INT32 node);
@@ -418,6 +419,9 @@ void NetUpdate(void);
 // Maintain connections to nodes without timing them all out.
 void NetKeepAlive(void);
 
+// Dedicated server: block on the network until the next frame is due.
+boolean NetWaitForPackets(precise_t until);
+
 void SV_StartSinglePlayerServer(void);
 boolean SV_SpawnServer(void);
 void SV_StopServer(void);
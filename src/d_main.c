@@ -50,6 +50,7 @@
 #include "p_saveg.h"
 #include "r_main.h"
 #include "r_local.h"
+#include "r_patchrotation.h" // RotatedPatch_UpdateCache
 #include "s_sound.h"
 #include "st_stuff.h"
 #include "v_video.h"
@@ -71,6 +72,7 @@
 #include "g_input.h" // tutorial mode control scheming
 #include "m_perfstats.h"
 #include "m_random.h"
+#include "d_soaktest.h"
 #include "command.h"
 
 #ifdef CMAKECONFIG
@@ -488,6 +490,7 @@ static void D_Display(void)
 			if (!automapactive && !dedicated && cv_renderview.value)
 			{
 				R_ApplyLevelInterpolators(R_UsingFrameInterpolation() ? rendertimefrac : FRACUNIT);
+				PS_TRACE_BEGIN("Render");
 				PS_START_TIMING(ps_rendercalltime);
 				if (players[displayplayer].mo || players[displayplayer].playerstate == PST_DEAD)
 				{
@@ -536,6 +539,7 @@ static void D_Display(void)
 						V_DoPostProcessor(1, postimgtype2, postimgparam2);
 				}
 				PS_STOP_TIMING(ps_rendercalltime);
+				PS_TRACE_END("Render");
 				R_RestoreLevelInterpolators();
 			}
 
@@ -607,6 +611,11 @@ static void D_Display(void)
 
 	PS_STOP_TIMING(ps_uitime);
 
+#ifdef ROTSPRITE
+	// Nothing is holding on to rotated sprites anymore
+	RotatedPatch_UpdateCache();
+#endif
+
 	//
 	// wipe update
 	//
@@ -691,10 +700,14 @@ static void D_Display(void)
 			M_DrawPerfStats();
 		}
 
+		PS_TRACE_BEGIN("I_FinishUpdate");
 		PS_START_TIMING(ps_swaptime);
 		I_FinishUpdate(); // page flip or blit buffer
 		PS_STOP_TIMING(ps_swaptime);
+		PS_TRACE_END("I_FinishUpdate");
 	}
+
+	V_EndDirtyFrame(!wipe);
 }
 
 // =========================================================================
@@ -897,8 +910,6 @@ void D_SRB2Loop(void)
 		HW3S_EndFrameUpdate();
 #endif
 
-		LUA_Step();
-
 		// Fully completed frame made.
 		finishprecise = I_GetPreciseTime();
 		if (!singletics)
@@ -910,9 +921,20 @@ void D_SRB2Loop(void)
 
 			if (elapsed > 0 && (INT64)capbudget > elapsed && !vsync_with_match_refresh)
 			{
-				I_SleepDuration(capbudget - (finishprecise - enterprecise));
+				// Give half of the slack to the Lua garbage collector,
+				// then sleep away whatever is left of it.
+				LUA_Step((capbudget - elapsed) / 2);
+
+				finishprecise = I_GetPreciseTime();
+				elapsed = (INT64)(finishprecise - enterprecise);
+				if ((INT64)capbudget > elapsed && !NetWaitForPackets(enterprecise + capbudget))
+					I_SleepDuration(capbudget - elapsed);
 			}
+			else
+				LUA_Step(0);
 		}
+		else
+			LUA_Step(0);
 		// Capture the time once more to get the real delta time.
 		finishprecise = I_GetPreciseTime();
 		deltasecs = (double)((INT64)(finishprecise - enterprecise)) / I_GetPrecisePrecision();
@@ -1613,6 +1635,8 @@ void D_SRB2Main(void)
 	if (D_CheckNetGame())
 		autostart = true;
 
+	D_SoakTestInit();
+
 	// check for a driver that wants intermission stats
 	// start the apropriate game based on parms
 	if (M_CheckParm("-metal"))
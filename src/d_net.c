@@ -70,6 +70,7 @@ boolean (*I_NetGet)(void) = NULL;
 void (*I_NetSend)(void) = NULL;
 boolean (*I_NetCanSend)(void) = NULL;
 boolean (*I_NetCanGet)(void) = NULL;
+boolean (*I_NetWaitForPacket)(UINT32 timeout) = NULL;
 void (*I_NetCloseSocket)(void) = NULL;
 void (*I_NetFreeNodenum)(INT32 nodenum) = NULL;
 SINT8 (*I_NetMakeNodewPort)(const char *address, const char* port) = NULL;
@@ -90,6 +91,7 @@ INT64 sendbytes = 0;
 static INT32 retransmit = 0, duppacket = 0;
 static INT32 sendackpacket = 0, getackpacket = 0;
 INT32 ticruned = 0, ticmiss = 0;
+netnodestat_t netnodestats[MAXNETNODES];
 
 // globals
 INT32 getbps, sendbps;
@@ -514,6 +516,7 @@ void Net_AckTicker(void)
 			ackpak[i].resentnum++;
 			ackpak[i].nextacknum = node->nextacknum;
 			retransmit++; // For stat
+			netnodestats[nodei].retransmits++;
 			HSendPacket((INT32)(node - nodes), false, ackpak[i].acknum,
 				(size_t)(ackpak[i].length - BASEPACKETSIZE));
 		}
@@ -1068,6 +1071,11 @@ boolean HSendPacket(INT32 node, boolean reliable, UINT8 acknum, size_t packetlen
 
 	netbuffer->checksum = NetbufferChecksum();
 	sendbytes += packetheaderlength + doomcom->datalength; // For stat
+	if (node < MAXNETNODES) // Can be a broadcast
+	{
+		netnodestats[node].sentbytes += packetheaderlength + doomcom->datalength;
+		netnodestats[node].sentpackets++;
+	}
 
 #ifdef PACKETDROP
 	// Simulate internet :)
@@ -1146,6 +1154,9 @@ boolean HGetPacket(void)
 			continue;
 		}
 
+		netnodestats[doomcom->remotenode].getbytes += packetheaderlength + doomcom->datalength;
+		netnodestats[doomcom->remotenode].getpackets++;
+
 		nodes[doomcom->remotenode].lasttimepacketreceived = I_GetTime();
 
 		if (netbuffer->checksum != NetbufferChecksum())
@@ -1268,6 +1279,7 @@ boolean D_CheckNetGame(void)
 	I_NetGet = Internal_Get;
 	I_NetSend = Internal_Send;
 	I_NetCanSend = NULL;
+	I_NetWaitForPacket = NULL;
 	I_NetCloseSocket = NULL;
 	I_NetFreeNodenum = Internal_FreeNodenum;
 	I_NetMakeNodewPort = NULL;
@@ -1460,6 +1472,7 @@ void D_CloseConnection(void)
 		I_NetGet = Internal_Get;
 		I_NetSend = Internal_Send;
 		I_NetCanSend = NULL;
+		I_NetWaitForPacket = NULL;
 		I_NetCloseSocket = NULL;
 		I_NetFreeNodenum = Internal_FreeNodenum;
 		I_NetMakeNodewPort = NULL;
@@ -37,6 +37,17 @@ boolean Net_GetNetStat(void);
 extern INT32 getbytes;
 extern INT64 sendbytes; // Realtime updated
 
+// Per node traffic, counted since startup; never reset
+typedef struct
+{
+	UINT64 sentbytes, getbytes;
+	UINT32 sentpackets, getpackets;
+	UINT32 retransmits; // Packets resent by Net_AckTicker
+	UINT32 synchfailures; // Consistency failures detected by the server
+} netnodestat_t;
+
+extern netnodestat_t netnodestats[MAXNETNODES];
+
 extern SINT8 nodetoplayer[MAXNETNODES];
 extern SINT8 nodetoplayer2[MAXNETNODES]; // Say the numplayer for this node if any (splitscreen)
 extern UINT8 playerpernode[MAXNETNODES]; // Used specially for splitscreen
@@ -26,6 +26,7 @@
 #include "r_skins.h"
 #include "p_local.h"
 #include "p_setup.h"
+#include "p_saveg.h"
 #include "s_sound.h"
 #include "i_sound.h"
 #include "m_misc.h"
@@ -127,6 +128,7 @@ static void Command_Pause(void);
 static void Command_Suicide(void);
 
 static void Command_Version_f(void);
+static void Command_PS_TraceDump_f(void);
 #ifdef UPDATE_ALERT
 static void Command_ModDetails_f(void);
 #endif
@@ -164,6 +166,10 @@ static void Command_Cheats_f(void);
 #ifdef _DEBUG
 static void Command_Togglemodified_f(void);
 static void Command_Archivetest_f(void);
+static void Command_Spritebench_f(void);
+#ifdef ALLOW_RESETDATA
+static void Command_Resetdatabench_f(void);
+#endif
 #endif
 
 // =========================================================================
@@ -384,6 +390,7 @@ consvar_t cv_ps_samplesize = CVAR_INIT ("ps_samplesize", "1", CV_CALL, ps_sample
 static CV_PossibleValue_t ps_descriptor_cons_t[] = {
 	{1, "Average"}, {2, "SD"}, {3, "Minimum"}, {4, "Maximum"}, {0, NULL}};
 consvar_t cv_ps_descriptor = CVAR_INIT ("ps_descriptor", "Average", 0, ps_descriptor_cons_t, NULL);
+consvar_t cv_ps_trace = CVAR_INIT ("ps_trace", "Off", CV_CALL, CV_OnOff, PS_Trace_OnChange);
 
 consvar_t cv_freedemocamera = CVAR_INIT("freedemocamera", "Off", CV_SAVE, CV_OnOff, NULL);
 
@@ -512,6 +519,10 @@ void D_RegisterServerCommands(void)
 #ifdef _DEBUG
 	COM_AddCommand("togglemodified", Command_Togglemodified_f, COM_LUA);
 	COM_AddCommand("archivetest", Command_Archivetest_f, COM_LUA);
+	COM_AddCommand("spritebench", Command_Spritebench_f, COM_LUA);
+#ifdef ALLOW_RESETDATA
+	COM_AddCommand("resetdatabench", Command_Resetdatabench_f, COM_LUA);
+#endif
 #endif
 
 	COM_AddCommand("downloads", Command_Downloads_f, COM_LUA);
@@ -600,6 +611,7 @@ void D_RegisterServerCommands(void)
 	CV_RegisterVar(&cv_showjoinaddress);
 	CV_RegisterVar(&cv_blamecfail);
 	CV_RegisterVar(&cv_dedicatedidletime);
+	CV_RegisterVar(&cv_dedicatedeventloop);
 #endif
 
 	COM_AddCommand("ping", Command_Ping_f, COM_LUA);
@@ -891,6 +903,8 @@ void D_RegisterClientCommands(void)
 	CV_RegisterVar(&cv_perfstats);
 	CV_RegisterVar(&cv_ps_samplesize);
 	CV_RegisterVar(&cv_ps_descriptor);
+	CV_RegisterVar(&cv_ps_trace);
+	COM_AddCommand("ps_tracedump", Command_PS_TraceDump_f, 0);
 
 	// ingame object placing
 	COM_AddCommand("objectplace", Command_ObjectPlace_f, COM_LUA);
@@ -3875,6 +3889,32 @@ static void Command_ListWADS_f(void)
 //                            MISC. COMMANDS
 // =========================================================================
 
+/** Writes the perfstats trace to a Chrome trace event file in srb2home,
+  * optionally only for a range of tics.
+  */
+static void Command_PS_TraceDump_f(void)
+{
+	char name[256];
+	tic_t first = 0, last = UINT32_MAX;
+
+	if (COM_Argc() < 2 || COM_Argc() > 4)
+	{
+		CONS_Printf(M_GetText("ps_tracedump <filename> [first tic] [last tic]: write the trace recorded with ps_trace (current tic is %u)\n"), gametic);
+		return;
+	}
+
+	if (COM_Argc() > 2)
+		first = (tic_t)strtoul(COM_Argv(2), NULL, 10);
+	if (COM_Argc() > 3)
+		last = (tic_t)strtoul(COM_Argv(3), NULL, 10);
+
+	strlcpy(name, COM_Argv(1), sizeof (name));
+	FIL_DefaultExtension(name, ".json");
+
+	if (!PS_DumpTrace(va("%s"PATHSEP"%s", srb2home, name), first, last))
+		CONS_Alert(CONS_ERROR, M_GetText("Couldn't write %s\n"), name);
+}
+
 /** Prints program version.
   */
 static void Command_Version_f(void)
@@ -4747,7 +4787,6 @@ static void Command_Togglemodified_f(void)
 	modifiedgame = !modifiedgame;
 }
 
-extern UINT8 *save_p;
 static void Command_Archivetest_f(void)
 {
 	UINT8 *buf;
@@ -4765,14 +4804,16 @@ static void Command_Archivetest_f(void)
 		if (th->function.acp1 != (actionf_p1)P_RemoveThinkerDelayed)
 			((mobj_t *)th)->mobjnum = i++;
 
-	// allocate buffer
-	buf = save_p = ZZ_Alloc(1024);
-
 	// test archive
+	P_SaveBufferAlloc(1024, NULL);
 	CONS_Printf("LUA_Archive...\n");
 	LUA_Archive();
 	WRITEUINT8(save_p, 0x7F);
-	wrote = (UINT32)(save_p-buf);
+	{
+		size_t length;
+		buf = P_SaveBufferFinish(&length);
+		wrote = (UINT32)length;
+	}
 
 	// clear Lua state, so we can really see what happens!
 	CONS_Printf("Clearing state!\n");
@@ -4787,9 +4828,98 @@ static void Command_Archivetest_f(void)
 		CONS_Printf("Savegame corrupted. (write %u, read %u)\n", wrote, (UINT32)(save_p-buf));
 
 	// free buffer
-	Z_Free(buf);
+	free(buf);
+	save_p = NULL;
 	CONS_Printf("Done. No crash.\n");
 }
+
+// Fills the area around the player with rings, to time sorting and
+// drawing sprites in a crowded scene with perfstats.
+static void Command_Spritebench_f(void)
+{
+	mobj_t *mo;
+	INT32 count, side, i;
+
+	if (COM_Argc() != 2)
+	{
+		CONS_Printf("spritebench <count>: spawn rings around you\n");
+		return;
+	}
+
+	if (gamestate != GS_LEVEL || netgame || !players[consoleplayer].mo)
+	{
+		CONS_Printf("This command only works in-game, offline.\n");
+		return;
+	}
+
+	count = atoi(COM_Argv(1));
+	if (count <= 0)
+		return;
+
+	mo = players[consoleplayer].mo;
+	for (side = 1; side * side < count; side++)
+		;
+
+	for (i = 0; i < count; i++)
+	{
+		fixed_t x = mo->x + ((i % side) - side/2) * 48*FRACUNIT;
+		fixed_t y = mo->y + ((i / side) - side/2) * 48*FRACUNIT;
+		P_SpawnMobj(x, y, mo->z + 32*FRACUNIT, MT_RING);
+	}
+
+	CONS_Printf("Spawned %d rings; perfstats 1 shows the sprite sort time.\n", count);
+}
+
+#ifdef ALLOW_RESETDATA
+// Times RESETDATA on the states table for different numbers of changed
+// entries, and checks that the table really comes back the way it was.
+static void Command_Resetdatabench_f(void)
+{
+	static const size_t counts[] = {1, 16, 128, 1024, NUMSTATES};
+	const UINT64 precision = I_GetPrecisePrecision();
+	state_t *copy;
+	precise_t start, elapsed;
+	size_t c, i;
+
+	if (P_JournaledInfoCount(INFOTABLE_STATES))
+	{
+		CONS_Printf("States have been changed by addons, which this would undo. Try again without any loaded.\n");
+		return;
+	}
+
+	copy = Z_Malloc(sizeof (states), PU_STATIC, NULL);
+	M_Memcpy(copy, states, sizeof (states));
+
+	for (c = 0; c < sizeof (counts) / sizeof (counts[0]); c++)
+	{
+		const size_t n = counts[c];
+
+		// Spread the changes out over the whole table
+		for (i = 0; i < n; i++)
+		{
+			const size_t index = i * (NUMSTATES / n);
+			P_JournalInfo(INFOTABLE_STATES, index);
+			states[index].tics++;
+		}
+
+		start = I_GetPreciseTime();
+		P_ResetData(2);
+		elapsed = I_GetPreciseTime() - start;
+
+		CONS_Printf("%5s changed: restored in %6u ns%s\n", sizeu1(n),
+			(UINT32)(elapsed * 1000000000 / precision),
+			memcmp(copy, states, sizeof (states)) ? " \x85(MISMATCH)" : "");
+	}
+
+	// For comparison, what putting back the whole table costs
+	start = I_GetPreciseTime();
+	M_Memcpy(states, copy, sizeof (states));
+	elapsed = I_GetPreciseTime() - start;
+	CONS_Printf("Copying back all %s states: %u ns\n", sizeu1(NUMSTATES), (UINT32)(elapsed * 1000000000 / precision));
+
+	Z_Free(copy);
+}
+#endif
 #endif
 
 /** Makes a change to ::cv_forceskin take effect immediately.
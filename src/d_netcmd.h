@@ -113,6 +113,7 @@ extern consvar_t cv_sleep;
 extern consvar_t cv_perfstats;
 extern consvar_t cv_ps_samplesize;
 extern consvar_t cv_ps_descriptor;
+extern consvar_t cv_ps_trace;
 
 extern char timedemo_name[256];
 extern boolean timedemo_csv;
@@ -0,0 +1,213 @@
+// SONIC ROBO BLAST 2
+//-----------------------------------------------------------------------------
+// Copyright (C) 2023 by Sonic Team Junior.
+//
+// This program is free software distributed under the
+// terms of the GNU General Public License, version 2.
+// See the 'LICENSE' file for more details.
+//-----------------------------------------------------------------------------
+/// \file  d_soaktest.c
+/// \brief Netgame soak testing with scripted clients
+///
+///        Run a dedicated server and any number of clients with
+///        "-soaktest <tics>". Clients play with scripted input, and the
+///        server waits for "-soakclients <n>" players, records every tic
+///        for the given amount of tics to "-soaklog <file>" as CSV, prints
+///        a summary and quits. See tools/soaktest for a launcher script.
+
+#include "doomdef.h"
+#include "doomstat.h"
+#include "d_soaktest.h"
+#include "d_clisrv.h"
+#include "d_net.h"
+#include "d_player.h"
+#include "i_system.h"
+#include "m_argv.h"
+#include "command.h"
+#include "console.h"
+#include "d_main.h" // pandf
+#include "g_game.h"
+#include "p_tick.h" // leveltime
+
+boolean soaktest = false;
+
+static tic_t soaktics; // Tics to record
+static INT32 soakclients; // Players to wait for before recording
+static tic_t soaktic; // Tics recorded so far
+static FILE *soaklog;
+
+// Scripted input state
+static UINT32 soakseed;
+static INT16 soakangle;
+static INT32 soakturn;
+static tic_t soaknextturn;
+
+// Traffic at the previous tic, to log deltas
+static netnodestat_t soaklast[MAXNETNODES];
+
+// Summary
+static UINT64 soaktotaltime;
+static precise_t soakmaxtime;
+static UINT32 soakdesynched; // Tics with at least one new synch failure
+
+/** Initializes soak testing from the command line.
+  */
+void D_SoakTestInit(void)
+{
+	const char *logname = "soaktest.csv";
+
+	if (!M_CheckParm("-soaktest"))
+		return;
+
+	if (!M_IsNextParm())
+		I_Error("usage: -soaktest <tics>\n");
+
+	soaktest = true;
+	soaktics = atoi(M_GetNextParm());
+
+	if (M_CheckParm("-soakclients") && M_IsNextParm())
+		soakclients = atoi(M_GetNextParm());
+
+	if (M_CheckParm("-soaklog") && M_IsNextParm())
+		logname = M_GetNextParm();
+
+	soakseed = (UINT32)I_GetPreciseTime();
+
+	if (!dedicated)
+		return;
+
+	soaklog = fopen(va(pandf, srb2home, logname), "w");
+	if (!soaklog)
+		I_Error("Couldn't open %s for writing\n", logname);
+
+	fprintf(soaklog, "tic,tic_us,node,player,sent_bytes,sent_packets,get_bytes,get_packets,resends,synch_failures\n");
+
+	CONS_Printf("Soak test: %u tics, waiting for %d clients\n", soaktics, soakclients);
+}
+
+static UINT64 SoakMicros(precise_t t)
+{
+	return (UINT64)t * 1000000 / I_GetPrecisePrecision();
+}
+
+// Simple LCG, so scripted input doesn't touch the game's RNG
+static UINT32 SoakRandom(void)
+{
+	soakseed = soakseed * 1103515245 + 12345;
+	return soakseed >> 16;
+}
+
+/** Builds a scripted ticcmd, in the spirit of the bots in b_bot.c:
+  * mostly run forward, turn every now and then, jump and spin at random.
+  *
+  * \param cmd The ticcmd to fill.
+  */
+void D_SoakTestBuildTiccmd(ticcmd_t *cmd)
+{
+	if (gamestate != GS_LEVEL)
+		return;
+
+	if (leveltime >= soaknextturn)
+	{
+		soakturn = (INT32)(SoakRandom() % 1024) - 512;
+		soaknextturn = leveltime + TICRATE/2 + SoakRandom() % (3*TICRATE);
+	}
+
+	soakangle = (INT16)(soakangle + soakturn);
+
+	cmd->forwardmove = 50;
+	cmd->sidemove = (SINT8)((SoakRandom() % 3 == 0) ? (SoakRandom() % 101) - 50 : 0);
+	cmd->angleturn = soakangle;
+	cmd->aiming = 0;
+	cmd->buttons = 0;
+
+	if (SoakRandom() % 16 == 0)
+		cmd->buttons |= BT_JUMP;
+	if (SoakRandom() % 64 == 0)
+		cmd->buttons |= BT_SPIN;
+}
+
+static void SoakTestFinish(void)
+{
+	INT32 node;
+
+	CONS_Printf("Soak test finished: %u tics, average tic %s us, worst tic %s us, %u tics with synch failures\n",
+		soaktic,
+		sizeu1((size_t)(soaktotaltime / max(soaktic, 1))),
+		sizeu2((size_t)SoakMicros(soakmaxtime)),
+		soakdesynched);
+
+	for (node = 1; node < MAXNETNODES; node++)
+	{
+		const netnodestat_t *stat = &netnodestats[node];
+
+		if (!stat->sentpackets && !stat->getpackets)
+			continue;
+
+		CONS_Printf("  node %d: sent %s bytes in %u packets, got %s bytes in %u packets, %u resends, %u synch failures\n",
+			node,
+			sizeu1((size_t)stat->sentbytes), stat->sentpackets,
+			sizeu2((size_t)stat->getbytes), stat->getpackets,
+			stat->retransmits, stat->synchfailures);
+	}
+
+	fclose(soaklog);
+	soaklog = NULL;
+
+	COM_ImmedExecute("quit");
+}
+
+/** Records a game tic on the server: its duration, and the traffic and
+  * synch failures of each node since the previous tic.
+  *
+  * \param ticduration How long the tic took to run.
+  */
+void D_SoakTestTicker(precise_t ticduration)
+{
+	const UINT64 ticus = SoakMicros(ticduration);
+	boolean desynched = false;
+	INT32 node;
+
+	if (!soaklog || gamestate != GS_LEVEL)
+		return;
+
+	if (!soaktic)
+	{
+		if (D_NumPlayers() < soakclients)
+			return;
+
+		// Only count traffic from here on
+		memcpy(soaklast, netnodestats, sizeof soaklast);
+	}
+
+	soaktotaltime += ticus;
+	if (ticduration > soakmaxtime)
+		soakmaxtime = ticduration;
+
+	for (node = 1; node < MAXNETNODES; node++)
+	{
+		const netnodestat_t *stat = &netnodestats[node];
+		netnodestat_t *last = &soaklast[node];
+
+		if (!nodeingame[node])
+			continue;
+
+		if (stat->synchfailures != last->synchfailures)
+			desynched = true;
+
+		fprintf(soaklog, "%u,%s,%d,%d,%s,%u,%s,%u,%u,%u\n",
+			gametic, sizeu1((size_t)ticus), node, nodetoplayer[node],
+			sizeu2((size_t)(stat->sentbytes - last->sentbytes)), stat->sentpackets - last->sentpackets,
+			sizeu3((size_t)(stat->getbytes - last->getbytes)), stat->getpackets - last->getpackets,
+			stat->retransmits - last->retransmits,
+			stat->synchfailures - last->synchfailures);
+
+		*last = *stat;
+	}
+
+	if (desynched)
+		soakdesynched++;
+
+	if (++soaktic >= soaktics)
+		SoakTestFinish();
+}
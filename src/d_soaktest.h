@@ -0,0 +1,29 @@
+// SONIC ROBO BLAST 2
+//-----------------------------------------------------------------------------
+// Copyright (C) 2023 by Sonic Team Junior.
+//
+// This program is free software distributed under the
+// terms of the GNU General Public License, version 2.
+// See the 'LICENSE' file for more details.
+//-----------------------------------------------------------------------------
+/// \file  d_soaktest.h
+/// \brief Netgame soak testing with scripted clients
+
+#ifndef __D_SOAKTEST__
+#define __D_SOAKTEST__
+
+#include "doomtype.h"
+#include "d_ticcmd.h"
+
+// True if the game was started with -soaktest
+extern boolean soaktest;
+
+void D_SoakTestInit(void);
+
+// Clients: replaces the local player's input with scripted input
+void D_SoakTestBuildTiccmd(ticcmd_t *cmd);
+
+// Server: records one game tic that took ticduration to run
+void D_SoakTestTicker(precise_t ticduration);
+
+#endif
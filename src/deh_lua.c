@@ -68,11 +68,15 @@ static inline int lib_freeslot(lua_State *L)
 				if (used_spr[(j-SPR_FIRSTFREESLOT)/8] & (1<<(j%8)))
 				{
 					if (!sprnames[j][4] && memcmp(sprnames[j],word,4)==0)
+					{
+						P_JournalInfo(INFOTABLE_SPRNAMES, j);
 						sprnames[j][4] = wad;
+					}
 					continue; // Already allocated, next.
 				}
 				// Found a free slot!
 				CONS_Printf("Sprite SPR_%s allocated.\n",word);
+				P_JournalInfo(INFOTABLE_SPRNAMES, j);
 				strncpy(sprnames[j],word,4);
 				//sprnames[j][4] = 0;
 				used_spr[(j-SPR_FIRSTFREESLOT)/8] |= 1<<(j%8); // Okay, this sprite slot has been named now.
@@ -93,6 +97,7 @@ static inline int lib_freeslot(lua_State *L)
 					CONS_Printf("State S_%s allocated.\n",word);
 					FREE_STATES[i] = Z_Malloc(strlen(word)+1, PU_STATIC, NULL);
 					strcpy(FREE_STATES[i],word);
+					DEH_AddStateName(S_FIRSTFREESLOT + i);
 					lua_pushinteger(L, S_FIRSTFREESLOT + i);
 					r++;
 					break;
@@ -108,6 +113,7 @@ static inline int lib_freeslot(lua_State *L)
 					CONS_Printf("MobjType MT_%s allocated.\n",word);
 					FREE_MOBJS[i] = Z_Malloc(strlen(word)+1, PU_STATIC, NULL);
 					strcpy(FREE_MOBJS[i],word);
+					DEH_AddMobjTypeName(MT_FIRSTFREESLOT + i);
 					lua_pushinteger(L, MT_FIRSTFREESLOT + i);
 					r++;
 					break;
@@ -224,6 +230,46 @@ static void CacheAndPushConstant(lua_State *L, const char *name, lua_Integer val
 	lua_pushinteger(L, value);
 }
 
+#define INTCONSTHASHSIZE 2048 // power of two, comfortably above the size of INT_CONST
+
+static UINT16 intconsthash[INTCONSTHASHSIZE]; // INT_CONST index + 1, 0 if empty
+static boolean intconsthashed = false;
+
+// Hashes INT_CONST, so the constants that aren't part of a
+// prefix family don't need a linear scan of the whole table.
+static void HashIntConsts(void)
+{
+	UINT32 slot;
+	size_t i;
+
+	for (i = 0; INT_CONST[i].n; i++)
+	{
+		for (slot = quickncasehash(INT_CONST[i].n, strlen(INT_CONST[i].n)); intconsthash[slot & (INTCONSTHASHSIZE-1)]; slot++)
+			;
+		intconsthash[slot & (INTCONSTHASHSIZE-1)] = (UINT16)(i + 1);
+	}
+
+	intconsthashed = true;
+}
+
+// Returns the INT_CONST index of a constant's name, or -1.
+static INT32 FindIntConst(const char *word)
+{
+	UINT32 slot;
+	UINT16 i;
+
+	if (!intconsthashed)
+		HashIntConsts();
+
+	for (slot = quickncasehash(word, strlen(word)); (i = intconsthash[slot & (INTCONSTHASHSIZE-1)]); slot++)
+	{
+		if (fastcmp(word, INT_CONST[i - 1].n))
+			return i - 1;
+	}
+
+	return -1;
+}
+
 // Search for a matching constant variable.
 // Result is stored into _G for faster subsequent use. (Except for SPR_ in the SOC parser)
 static int ScanConstants(lua_State *L, boolean mathlib, const char *word)
@@ -418,37 +464,19 @@ static int ScanConstants(lua_State *L, boolean mathlib, const char *word)
 		return 0;
 	}
 	else if (fastncmp("S_",word,2)) {
-		p = word+2;
-		for (i = 0; i < NUMSTATEFREESLOTS; i++) {
-			if (!FREE_STATES[i])
-				break;
-			if (fastcmp(p, FREE_STATES[i])) {
-				CacheAndPushConstant(L, word, S_FIRSTFREESLOT+i);
-				return 1;
-			}
+		i = DEH_FindState(word+2);
+		if (i != -1) {
+			CacheAndPushConstant(L, word, i);
+			return 1;
 		}
-		for (i = 0; i < S_FIRSTFREESLOT; i++)
-			if (fastcmp(p, STATE_LIST[i]+2)) {
-				CacheAndPushConstant(L, word, i);
-				return 1;
-			}
 		return luaL_error(L, "state '%s' does not exist.\n", word);
 	}
 	else if (fastncmp("MT_",word,3)) {
-		p = word+3;
-		for (i = 0; i < NUMMOBJFREESLOTS; i++) {
-			if (!FREE_MOBJS[i])
-				break;
-			if (fastcmp(p, FREE_MOBJS[i])) {
-				CacheAndPushConstant(L, word, MT_FIRSTFREESLOT+i);
-				return 1;
-			}
+		i = DEH_FindMobjType(word+3);
+		if (i != -1) {
+			CacheAndPushConstant(L, word, i);
+			return 1;
 		}
-		for (i = 0; i < MT_FIRSTFREESLOT; i++)
-			if (fastcmp(p, MOBJTYPE_LIST[i]+3)) {
-				CacheAndPushConstant(L, word, i);
-				return 1;
-			}
 		return luaL_error(L, "mobjtype '%s' does not exist.\n", word);
 	}
 	else if (fastncmp("SPR_",word,4)) {
@@ -488,30 +516,27 @@ static int ScanConstants(lua_State *L, boolean mathlib, const char *word)
 		return 0;
 	}
 	else if (!mathlib && fastncmp("sfx_",word,4)) {
-		p = word+4;
-		for (i = 0; i < NUMSFX; i++)
-			if (S_sfx[i].name && fastcmp(p, S_sfx[i].name)) {
-				CacheAndPushConstant(L, word, i);
-				return 1;
-			}
+		i = DEH_FindSfx(word+4, false);
+		if (i != -1) {
+			CacheAndPushConstant(L, word, i);
+			return 1;
+		}
 		return 0;
 	}
 	else if (mathlib && fastncmp("SFX_",word,4)) { // SOCs are ALL CAPS!
-		p = word+4;
-		for (i = 0; i < NUMSFX; i++)
-			if (S_sfx[i].name && fasticmp(p, S_sfx[i].name)) {
-				CacheAndPushConstant(L, word, i);
-				return 1;
-			}
+		i = DEH_FindSfx(word+4, true);
+		if (i != -1) {
+			CacheAndPushConstant(L, word, i);
+			return 1;
+		}
 		return luaL_error(L, "sfx '%s' could not be found.\n", word);
 	}
 	else if (mathlib && fastncmp("DS",word,2)) {
-		p = word+2;
-		for (i = 0; i < NUMSFX; i++)
-			if (S_sfx[i].name && fasticmp(p, S_sfx[i].name)) {
-				CacheAndPushConstant(L, word, i);
-				return 1;
-			}
+		i = DEH_FindSfx(word+2, true);
+		if (i != -1) {
+			CacheAndPushConstant(L, word, i);
+			return 1;
+		}
 		if (mathlib) return luaL_error(L, "sfx '%s' could not be found.\n", word);
 		return 0;
 	}
@@ -589,11 +614,12 @@ static int ScanConstants(lua_State *L, boolean mathlib, const char *word)
 		return 1;
 	}
 
-	for (i = 0; INT_CONST[i].n; i++)
-		if (fastcmp(word,INT_CONST[i].n)) {
-			CacheAndPushConstant(L, word, INT_CONST[i].v);
-			return 1;
-		}
+	i = FindIntConst(word);
+	if (i != -1)
+	{
+		CacheAndPushConstant(L, word, INT_CONST[i].v);
+		return 1;
+	}
 
 	return 0;
 }
@@ -616,14 +642,12 @@ static inline int lib_getenum(lua_State *L)
 		// Hardcoded actions come first.
 		// Trying to call them will invoke LUA_CallAction, which will handle super properly.
 		// Retrieving them from this metatable allows them to be case-insensitive!
-		for (i = 0; actionpointers[i].name; i++)
+		i = DEH_FindAction(word);
+		if (i != -1)
 		{
-			if (fasticmp(word, actionpointers[i].name))
-			{
-				// We push the actionf_t* itself as userdata!
-				LUA_PushUserdata(L, &actionpointers[i].action, META_ACTION);
-				return 1;
-			}
+			// We push the actionf_t* itself as userdata!
+			LUA_PushUserdata(L, &actionpointers[i].action, META_ACTION);
+			return 1;
 		}
 
 		// Now try to get Lua actions.
@@ -656,13 +680,11 @@ static inline int lib_getenum(lua_State *L)
 			return 1;
 		}
 
-		for (i = 0; actionpointers[i].name; i++)
+		i = DEH_FindAction(luaactions[luaactionstack-1]);
+		if (i != -1)
 		{
-			if (fasticmp(luaactions[luaactionstack-1], actionpointers[i].name))
-			{
-				LUA_PushUserdata(L, &actionpointers[i].action, META_ACTION);
-				return 1;
-			}
+			LUA_PushUserdata(L, &actionpointers[i].action, META_ACTION);
+			return 1;
 		}
 
 		// Not a hardcoded A_ action.
@@ -704,6 +726,9 @@ int LUA_EnumLib(lua_State *L)
 	if (lua_gettop(L) == 0)
 		lua_pushboolean(L, 0);
 
+	if (!intconsthashed)
+		HashIntConsts();
+
 	// Set the global metatable
 	lua_createtable(L, 0, 1);
 	lua_pushvalue(L, 1); // boolean passed to LUA_EnumLib as first argument.
@@ -793,24 +818,19 @@ const char *LUA_GetActionName(void *action)
 void LUA_SetActionByName(void *state, const char *actiontocompare)
 {
 	state_t *st = (state_t *)state;
-	size_t z;
-	for (z = 0; actionpointers[z].name; z++)
+	INT32 z = DEH_FindAction(actiontocompare);
+	if (z != -1)
 	{
-		if (fasticmp(actiontocompare, actionpointers[z].name))
-		{
-			st->action = actionpointers[z].action;
-			st->action.acv = actionpointers[z].action.acv; // assign
-			st->action.acp1 = actionpointers[z].action.acp1;
-			return;
-		}
+		st->action = actionpointers[z].action;
+		st->action.acv = actionpointers[z].action.acv; // assign
+		st->action.acp1 = actionpointers[z].action.acp1;
 	}
 }
 
 enum actionnum LUA_GetActionNumByName(const char *actiontocompare)
 {
-	size_t z;
-	for (z = 0; actionpointers[z].name; z++)
-		if (fasticmp(actiontocompare, actionpointers[z].name))
-			return z;
+	INT32 z = DEH_FindAction(actiontocompare);
+	if (z == -1)
+		return NUMACTIONS;
 	return z;
 }
@@ -48,9 +48,51 @@
 // also used for LUA_UpdateSprName
 #include "deh_tables.h"
 
+// Fast path for get_number: plain numbers and lone MT_, S_ and SFX_ names,
+// which is what most SOC values are, don't need a trip through Lua.
+// Returns false for anything else, including names that don't exist,
+// so that LUA_EvalMath still gets to report the error.
+static boolean get_simple_number(const char *word, fixed_t *value)
+{
+	const char *p = word;
+	INT32 i = -1;
+
+	if (*p == '-')
+		p++;
+	if (*p >= '0' && *p <= '9')
+	{
+		for (; *p; p++)
+			if (*p < '0' || *p > '9' || p - word >= 10)
+				return false;
+		*value = atoi(word);
+		return true;
+	}
+
+	for (p = word; *p; p++)
+		if (!((*p >= 'A' && *p <= 'Z') || (*p >= 'a' && *p <= 'z') || (*p >= '0' && *p <= '9') || *p == '_'))
+			return false;
+
+	if (fastncmp("MT_", word, 3))
+		i = DEH_FindMobjType(word + 3);
+	else if (fastncmp("S_", word, 2))
+		i = DEH_FindState(word + 2);
+	else if (fastncmp("SFX_", word, 4))
+		i = DEH_FindSfx(word + 4, true);
+
+	if (i == -1)
+		return false;
+	*value = i;
+	return true;
+}
+
 // Loops through every constant and operation in word and performs its calculations, returning the final value.
 fixed_t get_number(const char *word)
 {
+	fixed_t value;
+
+	if (get_simple_number(word, &value))
+		return value;
+
 	return LUA_EvalMath(word);
 
 	/*// DESPERATELY NEEDED: Order of operations support! :x
@@ -433,10 +475,14 @@ void readfreeslots(MYFILE *f)
 					if (used_spr[(i-SPR_FIRSTFREESLOT)/8] & (1<<(i%8)))
 					{
 						if (!sprnames[i][4] && memcmp(sprnames[i],word,4)==0)
+						{
+							P_JournalInfo(INFOTABLE_SPRNAMES, i);
 							sprnames[i][4] = (char)f->wad;
+						}
 						continue; // Already allocated, next.
 					}
 					// Found a free slot!
+					P_JournalInfo(INFOTABLE_SPRNAMES, i);
 					strncpy(sprnames[i],word,4);
 					//sprnames[i][4] = 0;
 					used_spr[(i-SPR_FIRSTFREESLOT)/8] |= 1<<(i%8); // Okay, this sprite slot has been named now.
@@ -451,6 +497,7 @@ void readfreeslots(MYFILE *f)
 					if (!FREE_STATES[i]) {
 						FREE_STATES[i] = Z_Malloc(strlen(word)+1, PU_STATIC, NULL);
 						strcpy(FREE_STATES[i],word);
+						DEH_AddStateName(S_FIRSTFREESLOT+i);
 						break;
 					}
 			}
@@ -460,6 +507,7 @@ void readfreeslots(MYFILE *f)
 					if (!FREE_MOBJS[i]) {
 						FREE_MOBJS[i] = Z_Malloc(strlen(word)+1, PU_STATIC, NULL);
 						strcpy(FREE_MOBJS[i],word);
+						DEH_AddMobjTypeName(MT_FIRSTFREESLOT+i);
 						break;
 					}
 			}
@@ -526,6 +574,8 @@ void readthing(MYFILE *f, INT32 num)
 	char *word, *word2;
 	char *tmp;
 
+	P_JournalInfo(INFOTABLE_MOBJINFO, num);
+
 	do
 	{
 		if (myfgets(s, MAXLINELEN, f))
@@ -665,6 +715,7 @@ void readskincolor(MYFILE *f, INT32 num)
 	char *tmp;
 
 	Color_cons_t[num].value = num;
+	P_JournalInfo(INFOTABLE_SKINCOLORS, num);
 
 	do
 	{
@@ -2713,6 +2764,8 @@ void readframe(MYFILE *f, INT32 num)
 	char *word2 = NULL;
 	char *tmp;
 
+	P_JournalInfo(INFOTABLE_STATES, num);
+
 	do
 	{
 		if (myfgets(s, MAXLINELEN, f))
@@ -2767,6 +2820,7 @@ void readframe(MYFILE *f, INT32 num)
 			else if (fastcmp(word1, "ACTION"))
 			{
 				size_t z;
+				INT32 action;
 				boolean found = false;
 				size_t actionlen = strlen(word2) + 1;
 				char *actiontocompare = calloc(actionlen, 1);
@@ -2783,28 +2837,15 @@ void readframe(MYFILE *f, INT32 num)
 					}
 				}
 
-				for (z = 0; actionpointers[z].name; z++)
+				found = LUA_SetLuaAction(&states[num], actiontocompare);
+				if (!found && (action = DEH_FindAction(actiontocompare)) != -1)
 				{
-					if (actionpointers[z].action.acv == states[num].action.acv)
-						break;
+					states[num].action = actionpointers[action].action;
+					states[num].action.acv = actionpointers[action].action.acv; // assign
+					states[num].action.acp1 = actionpointers[action].action.acp1;
+					found = true;
 				}
 
-				z = 0;
-				found = LUA_SetLuaAction(&states[num], actiontocompare);
-				if (!found)
-					while (actionpointers[z].name)
-					{
-						if (fastcmp(actiontocompare, actionpointers[z].name))
-						{
-							states[num].action = actionpointers[z].action;
-							states[num].action.acv = actionpointers[z].action.acv; // assign
-							states[num].action.acp1 = actionpointers[z].action.acp1;
-							found = true;
-							break;
-						}
-						z++;
-					}
-
 				if (!found)
 					deh_warning("Unknown action %s", actiontocompare);
 
@@ -4091,40 +4132,26 @@ void readwipes(MYFILE *f)
 
 mobjtype_t get_mobjtype(const char *word)
 { // Returns the value of MT_ enumerations
-	mobjtype_t i;
+	INT32 i;
 	if (*word >= '0' && *word <= '9')
 		return atoi(word);
 	if (fastncmp("MT_",word,3))
 		word += 3; // take off the MT_
-	for (i = 0; i < NUMMOBJFREESLOTS; i++) {
-		if (!FREE_MOBJS[i])
-			break;
-		if (fastcmp(word, FREE_MOBJS[i]))
-			return MT_FIRSTFREESLOT+i;
-	}
-	for (i = 0; i < MT_FIRSTFREESLOT; i++)
-		if (fastcmp(word, MOBJTYPE_LIST[i]+3))
-			return i;
+	if ((i = DEH_FindMobjType(word)) != -1)
+		return i;
 	deh_warning("Couldn't find mobjtype named 'MT_%s'",word);
 	return MT_NULL;
 }
 
 statenum_t get_state(const char *word)
 { // Returns the value of S_ enumerations
-	statenum_t i;
+	INT32 i;
 	if (*word >= '0' && *word <= '9')
 		return atoi(word);
 	if (fastncmp("S_",word,2))
 		word += 2; // take off the S_
-	for (i = 0; i < NUMSTATEFREESLOTS; i++) {
-		if (!FREE_STATES[i])
-			break;
-		if (fastcmp(word, FREE_STATES[i]))
-			return S_FIRSTFREESLOT+i;
-	}
-	for (i = 0; i < S_FIRSTFREESLOT; i++)
-		if (fastcmp(word, STATE_LIST[i]+2))
-			return i;
+	if ((i = DEH_FindState(word)) != -1)
+		return i;
 	deh_warning("Couldn't find state named 'S_%s'",word);
 	return S_NULL;
 }
@@ -4179,16 +4206,15 @@ playersprite_t get_sprite2(const char *word)
 
 sfxenum_t get_sfx(const char *word)
 { // Returns the value of SFX_ enumerations
-	sfxenum_t i;
+	INT32 i;
 	if (*word >= '0' && *word <= '9')
 		return atoi(word);
 	if (fastncmp("SFX_",word,4))
 		word += 4; // take off the SFX_
 	else if (fastncmp("DS",word,2))
 		word += 2; // take off the DS
-	for (i = 0; i < NUMSFX; i++)
-		if (S_sfx[i].name && fasticmp(word, S_sfx[i].name))
-			return i;
+	if ((i = DEH_FindSfx(word, true)) != -1)
+		return i;
 	deh_warning("Couldn't find sfx named 'SFX_%s'",word);
 	return sfx_None;
 }
@@ -25,6 +25,8 @@
 #include "g_game.h" // Joystick axes (for lua)
 #include "i_joy.h"
 #include "g_input.h" // Game controls (for lua)
+#include "z_zone.h"
+#include "fastcmp.h"
 
 #include "deh_tables.h"
 
@@ -5816,3 +5818,171 @@ void DEH_TableCheck(void)
 		I_Error("You forgot to update the Dehacked colors list, you dolt!\n(%d colors defined, versus %s in the Dehacked list)\n", SKINCOLOR_FIRSTFREESLOT, sizeu1(dehcolors));
 #endif
 }
+
+// Name indexes for the constant tables, so looking a name up doesn't
+// compare it against thousands of strings. Built the first time they're
+// used; freeslots allocated after that are added as they're named.
+typedef struct
+{
+	INT32 *heads; // first entry in each bucket, -1 if none
+	INT32 *next; // next entry in the same bucket
+	UINT32 mask;
+} dehnameindex_t;
+
+#define DEHNAMEHASHLEN 32 // characters of a name that go into its hash
+
+static dehnameindex_t mobjtypeindex, stateindex, sfxindex, actionindex;
+
+static const char *MobjTypeName(INT32 i)
+{
+	if (i >= MT_FIRSTFREESLOT)
+		return FREE_MOBJS[i - MT_FIRSTFREESLOT];
+	return MOBJTYPE_LIST[i]+3; // MT_
+}
+
+static const char *StateName(INT32 i)
+{
+	if (i >= S_FIRSTFREESLOT)
+		return FREE_STATES[i - S_FIRSTFREESLOT];
+	return STATE_LIST[i]+2; // S_
+}
+
+static const char *SfxName(INT32 i)
+{
+	return S_sfx[i].name;
+}
+
+static const char *ActionName(INT32 i)
+{
+	return actionpointers[i].name;
+}
+
+static void DEH_InsertName(dehnameindex_t *index, INT32 i, const char *name)
+{
+	UINT32 bucket = quickncasehash(name, DEHNAMEHASHLEN) & index->mask;
+	index->next[i] = index->heads[bucket];
+	index->heads[bucket] = i;
+}
+
+// Entries from first to last are put in front of everything already in
+// the index, and each chain lists lower numbers first among them. That
+// way freeslots are found before built-ins, the same as the old searches.
+static void DEH_InsertNames(dehnameindex_t *index, INT32 first, INT32 last, const char *(*getname)(INT32))
+{
+	INT32 i;
+
+	for (i = last; i >= first; i--)
+	{
+		const char *name = getname(i);
+
+		if (name)
+			DEH_InsertName(index, i, name);
+	}
+}
+
+static void DEH_BuildNameIndex(dehnameindex_t *index, INT32 count)
+{
+	UINT32 size = 1;
+
+	while (size < (UINT32)count)
+		size <<= 1;
+
+	index->heads = Z_Malloc(size * sizeof (*index->heads), PU_STATIC, NULL);
+	index->next = Z_Malloc(count * sizeof (*index->next), PU_STATIC, NULL);
+	index->mask = size - 1;
+	memset(index->heads, 0xFF, size * sizeof (*index->heads));
+	memset(index->next, 0xFF, count * sizeof (*index->next));
+}
+
+static INT32 DEH_SearchNameIndex(const dehnameindex_t *index, const char *word, const char *(*getname)(INT32), boolean nocase)
+{
+	INT32 i;
+
+	for (i = index->heads[quickncasehash(word, DEHNAMEHASHLEN) & index->mask]; i != -1; i = index->next[i])
+	{
+		if (nocase ? fasticmp(word, getname(i)) : fastcmp(word, getname(i)))
+			return i;
+	}
+
+	return -1;
+}
+
+// Adds a newly named freeslot, unless an earlier freeslot already has its name.
+static void DEH_AddFreeslotName(dehnameindex_t *index, INT32 i, INT32 firstfreeslot, const char *(*getname)(INT32))
+{
+	INT32 found;
+
+	if (!index->heads) // Picked up when the index is built.
+		return;
+
+	found = DEH_SearchNameIndex(index, getname(i), getname, false);
+	if (found < firstfreeslot)
+		DEH_InsertName(index, i, getname(i));
+}
+
+INT32 DEH_FindMobjType(const char *word)
+{
+	if (!mobjtypeindex.heads)
+	{
+		DEH_BuildNameIndex(&mobjtypeindex, NUMMOBJTYPES);
+		DEH_InsertNames(&mobjtypeindex, 0, MT_FIRSTFREESLOT-1, MobjTypeName);
+		DEH_InsertNames(&mobjtypeindex, MT_FIRSTFREESLOT, NUMMOBJTYPES-1, MobjTypeName);
+	}
+	return DEH_SearchNameIndex(&mobjtypeindex, word, MobjTypeName, false);
+}
+
+INT32 DEH_FindState(const char *word)
+{
+	if (!stateindex.heads)
+	{
+		DEH_BuildNameIndex(&stateindex, NUMSTATES);
+		DEH_InsertNames(&stateindex, 0, S_FIRSTFREESLOT-1, StateName);
+		DEH_InsertNames(&stateindex, S_FIRSTFREESLOT, NUMSTATES-1, StateName);
+	}
+	return DEH_SearchNameIndex(&stateindex, word, StateName, false);
+}
+
+INT32 DEH_FindSfx(const char *word, boolean nocase)
+{
+	INT32 i;
+
+	if (!sfxindex.heads)
+	{
+		DEH_BuildNameIndex(&sfxindex, sfx_freeslot0);
+		DEH_InsertNames(&sfxindex, 0, sfx_freeslot0-1, SfxName);
+	}
+	i = DEH_SearchNameIndex(&sfxindex, word, SfxName, nocase);
+	if (i != -1)
+		return i;
+
+	// Sound freeslots get renamed as skins come and go, so they're searched directly.
+	for (i = sfx_freeslot0; i < NUMSFX; i++)
+		if (S_sfx[i].name && (nocase ? fasticmp(word, S_sfx[i].name) : fastcmp(word, S_sfx[i].name)))
+			return i;
+
+	return -1;
+}
+
+INT32 DEH_FindAction(const char *word)
+{
+	if (!actionindex.heads)
+	{
+		INT32 count;
+
+		for (count = 0; actionpointers[count].name; count++)
+			;
+		DEH_BuildNameIndex(&actionindex, count);
+		DEH_InsertNames(&actionindex, 0, count-1, ActionName);
+	}
+	return DEH_SearchNameIndex(&actionindex, word, ActionName, true);
+}
+
+void DEH_AddMobjTypeName(mobjtype_t type)
+{
+	DEH_AddFreeslotName(&mobjtypeindex, type, MT_FIRSTFREESLOT, MobjTypeName);
+}
+
+void DEH_AddStateName(statenum_t state)
+{
+	DEH_AddFreeslotName(&stateindex, state, S_FIRSTFREESLOT, StateName);
+}
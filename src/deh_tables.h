@@ -80,4 +80,15 @@ extern struct int_const_s const INT_CONST[];
 // Moved to this file because it can't work compile-time otherwise
 void DEH_TableCheck(void);
 
+// Name lookups for SOC and Lua, shared so both go through the same indexes.
+// Names are given without their prefix, except for actions; -1 if not found.
+INT32 DEH_FindMobjType(const char *word);
+INT32 DEH_FindState(const char *word);
+INT32 DEH_FindSfx(const char *word, boolean nocase);
+INT32 DEH_FindAction(const char *word);
+
+// Call after naming a freeslot, so later lookups can find it.
+void DEH_AddMobjTypeName(mobjtype_t type);
+void DEH_AddStateName(statenum_t state);
+
 #endif
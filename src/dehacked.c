@@ -613,6 +613,7 @@ static void DEH_LoadDehackedFile(MYFILE *f, boolean mainfile)
 void DEH_LoadDehackedLumpPwad(UINT16 wad, UINT16 lump, boolean mainfile)
 {
 	MYFILE f;
+	precise_t start = I_GetPreciseTime();
 	f.wad = wad;
 	f.size = W_LumpLengthPwad(wad, lump);
 	f.data = Z_Malloc(f.size + 1, PU_STATIC, NULL);
@@ -621,6 +622,8 @@ void DEH_LoadDehackedLumpPwad(UINT16 wad, UINT16 lump, boolean mainfile)
 	f.data[f.size] = 0;
 	DEH_LoadDehackedFile(&f, mainfile);
 	Z_Free(f.data);
+	CONS_Debug(DBG_SETUP, "SOC %s from %s took %d us\n", wadfiles[wad]->lumpinfo[lump].fullname, wadfiles[wad]->filename,
+		(int)((I_GetPreciseTime() - start) * 1000000 / I_GetPrecisePrecision()));
 }
 
 void DEH_LoadDehackedLump(lumpnum_t lumpnum)
@@ -683,9 +683,8 @@ extern int
 
 ///	Allow the use of the SOC RESETINFO command.
 ///	\note	Builds that are tight on memory should disable this.
-///	    	This stops the game from storing backups of the states, sprites, and mobjinfo tables.
-///	    	Though this info is compressed under normal circumstances, it's still a lot of extra
-///	    	memory that never gets touched.
+///	    	This stops the game from keeping copies of the states, sprites, mobjinfo and
+///	    	skincolors entries that SOC and Lua change, so that they can be put back.
 #define ALLOW_RESETDATA
 
 /// Experimental tweaks to analog mode. (Needs a lot of work before it's ready for primetime.)
@@ -544,6 +544,7 @@ void F_RunWipe(UINT8 wipetype, boolean drawMenu)
 	F_DecideWipeStyle();
 	WipeInAction = true;
 	wipe_scr = screens[0];
+	V_EndDirtyFrame(false);
 
 	// lastwipetic should either be 0 or the tic we last wiped
 	// on for fade-to-black
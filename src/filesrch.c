@@ -24,6 +24,11 @@
 #endif
 #include <sys/stat.h>
 #include <string.h>
+#ifdef _WIN32
+#include <sys/utime.h>
+#else
+#include <utime.h>
+#endif
 
 #include "filesrch.h"
 #include "d_netfil.h"
@@ -640,6 +645,82 @@ INT32 samepaths(const char *path1, const char *path2)
 	return 0;
 }
 
+typedef struct
+{
+	char *name;
+	time_t mtime;
+	size_t size;
+} cachefile_t;
+
+static int cachefilecmp(const void *a, const void *b)
+{
+	const cachefile_t *f1 = a, *f2 = b;
+	return (f1->mtime > f2->mtime) - (f1->mtime < f2->mtime);
+}
+
+// Marks a cache file as just used, by setting its modification time to now,
+// so that prunecachedirectory deletes it after the files that were not.
+void touchcachefile(const char *path)
+{
+	utime(path, NULL);
+}
+
+// Deletes the least recently used files ending in extension from
+// a cache directory, until what is left takes up at most maxsize bytes.
+void prunecachedirectory(const char *path, const char *extension, size_t maxsize)
+{
+	const size_t extlen = strlen(extension);
+	char filepath[dirpathlen];
+	cachefile_t *files = NULL;
+	size_t numfiles = 0, maxfiles = 0, total = 0, i;
+	struct dirent *dent;
+	struct stat fsstat;
+	DIR *dirhandle;
+
+	dirhandle = opendir(path);
+	if (!dirhandle)
+		return;
+
+	while ((dent = readdir(dirhandle)) != NULL)
+	{
+		const size_t len = strlen(dent->d_name);
+
+		if (len <= extlen || strcmp(dent->d_name + len - extlen, extension))
+			continue;
+
+		snprintf(filepath, sizeof filepath, "%s" PATHSEP "%s", path, dent->d_name);
+		if (stat(filepath, &fsstat) < 0 || !S_ISREG(fsstat.st_mode))
+			continue;
+
+		if (numfiles == maxfiles)
+		{
+			maxfiles = maxfiles ? maxfiles * 2 : 64;
+			files = Z_Realloc(files, maxfiles * sizeof (*files), PU_STATIC, NULL);
+		}
+		files[numfiles].name = Z_StrDup(dent->d_name);
+		files[numfiles].mtime = fsstat.st_mtime;
+		files[numfiles].size = (size_t)fsstat.st_size;
+		total += files[numfiles].size;
+		numfiles++;
+	}
+	closedir(dirhandle);
+
+	if (total > maxsize)
+	{
+		qsort(files, numfiles, sizeof (*files), cachefilecmp);
+		for (i = 0; i < numfiles && total > maxsize; i++)
+		{
+			snprintf(filepath, sizeof filepath, "%s" PATHSEP "%s", path, files[i].name);
+			if (remove(filepath) == 0)
+				total -= files[i].size;
+		}
+	}
+
+	for (i = 0; i < numfiles; i++)
+		Z_Free(files[i].name);
+	Z_Free(files);
+}
+
 //
 // Directory loading
 //
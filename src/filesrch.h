@@ -32,6 +32,8 @@ filestatus_t filesearch(char *filename, const char *startpath, const UINT8 *want
 INT32 pathisdirectory(const char *path);
 INT32 samepaths(const char *path1, const char *path2);
 INT32 concatpaths(const char *path, const char *startpath);
+void touchcachefile(const char *path);
+void prunecachedirectory(const char *path, const char *extension, size_t maxsize);
 
 #ifndef AVOID_ERRNO
 extern int direrror;
@@ -4839,12 +4839,7 @@ void G_SaveGame(UINT32 slot, INT16 mapnum)
 		char name[VERSIONSIZE];
 		size_t length;
 
-		save_p = savebuffer = (UINT8 *)malloc(SAVEGAMESIZE);
-		if (!save_p)
-		{
-			CONS_Alert(CONS_ERROR, M_GetText("No more free memory for saving game data\n"));
-			return;
-		}
+		P_SaveBufferAlloc(SAVEGAMESIZE, NULL);
 
 		memset(name, 0, sizeof (name));
 		sprintf(name, (marathonmode ? "back-up %d" : "version %d"), VERSION);
@@ -4860,10 +4855,10 @@ void G_SaveGame(UINT32 slot, INT16 mapnum)
 			WRITEUINT8(save_p, (marathonmode & ~MA_INIT));
 		}
 
-		length = save_p - savebuffer;
+		savebuffer = P_SaveBufferFinish(&length);
 		saved = FIL_WriteFile(backup, savebuffer, length);
 		free(savebuffer);
-		save_p = savebuffer = NULL;
+		savebuffer = NULL;
 	}
 
 	gameaction = ga_nothing;
@@ -6448,6 +6448,7 @@ void HWR_RenderPlayerView(INT32 viewnumber, player_t *player)
 
 	ps_numbspcalls.value.i = 0;
 	ps_numpolyobjects.value.i = 0;
+	PS_TRACE_BEGIN("HWR_RenderBSPNode");
 	PS_START_TIMING(ps_bsptime);
 
 	validcount++;
@@ -6487,6 +6488,7 @@ void HWR_RenderPlayerView(INT32 viewnumber, player_t *player)
 #endif
 
 	PS_STOP_TIMING(ps_bsptime);
+	PS_TRACE_END("HWR_RenderBSPNode");
 
 	if (cv_glbatching.value)
 		HWR_RenderBatches();
@@ -6502,12 +6504,16 @@ void HWR_RenderPlayerView(INT32 viewnumber, player_t *player)
 
 	// Draw MD2 and sprites
 	ps_numsprites.value.i = gl_visspritecount;
+	PS_TRACE_BEGIN("HWR_SortVisSprites");
 	PS_START_TIMING(ps_hw_spritesorttime);
 	HWR_SortVisSprites();
 	PS_STOP_TIMING(ps_hw_spritesorttime);
+	PS_TRACE_END("HWR_SortVisSprites");
+	PS_TRACE_BEGIN("HWR_DrawSprites");
 	PS_START_TIMING(ps_hw_spritedrawtime);
 	HWR_DrawSprites();
 	PS_STOP_TIMING(ps_hw_spritedrawtime);
+	PS_TRACE_END("HWR_DrawSprites");
 
 #ifdef NEWCORONAS
 	//Hurdler: they must be drawn before translucent planes, what about gl fog?
@@ -99,6 +99,14 @@ extern void (*I_NetSend)(void);
 */
 extern boolean (*I_NetCanSend)(void);
 
+/**	\brief block until data is waiting or the timeout runs out
+
+	\param	timeout	longest time to wait, in microseconds
+
+	\return	true if data is waiting
+*/
+extern boolean (*I_NetWaitForPacket)(UINT32 timeout);
+
 /**	\brief	close a connection
 
 	\param	nodenum	node to be closed
@@ -67,6 +67,11 @@
 		#if defined (__unix__) || defined (__APPLE__) || defined (UNIXCOMMON)
 			#include <sys/time.h>
 		#endif // UNIXCOMMON
+
+		#if defined (__linux__) && !defined (NOEPOLL)
+			#include <sys/epoll.h>
+			#define HAVE_EPOLL
+		#endif
 	#endif
 
 	#ifdef USE_WINSOCK
@@ -172,6 +177,9 @@
 	static size_t mysocketses = 0;
 	static int myfamily[MAXNETNODES+1] = {0};
 	static SOCKET_TYPE nodesocket[MAXNETNODES+1] = {ERRSOCKET};
+#ifdef HAVE_EPOLL
+	static int epollfd = -1; // watches every socket in mysockets
+#endif
 	static mysockaddr_t clientaddress[MAXNETNODES+1];
 	static mysockaddr_t broadcastaddress[MAXNETNODES+1];
 	static size_t broadcastaddresses = 0;
@@ -652,6 +660,34 @@ static boolean SOCK_CanGet(void)
 #endif
 
 #ifndef NONET
+// Block until one of our sockets has a packet waiting, or timeout
+// (in microseconds) runs out.
+static boolean SOCK_WaitForPacket(UINT32 timeout)
+{
+	struct timeval timeval_for_select;
+	fd_set tset;
+	SOCKET_TYPE maxfd = 0;
+	size_t i;
+
+#ifdef HAVE_EPOLL
+	if (epollfd != -1)
+	{
+		struct epoll_event ev;
+		// Round up, waking a little late is better than spinning
+		return epoll_wait(epollfd, &ev, 1, (int)((timeout + 999) / 1000)) > 0;
+	}
+#endif
+
+	tset = masterset;
+	for (i = 0; i < mysocketses; i++)
+		if (mysockets[i] != (SOCKET_TYPE)ERRSOCKET && mysockets[i] > maxfd)
+			maxfd = mysockets[i];
+
+	timeval_for_select.tv_sec = timeout / 1000000;
+	timeval_for_select.tv_usec = timeout % 1000000;
+	return select((int)maxfd + 1, &tset, NULL, NULL, &timeval_for_select) > 0;
+}
+
 static inline ssize_t SOCK_SendToAddr(SOCKET_TYPE socket, mysockaddr_t *sockaddr)
 {
 	socklen_t d4 = (socklen_t)sizeof(struct sockaddr_in);
@@ -988,6 +1024,22 @@ static boolean UDP_Socket(void)
 	if (s == 0) // no sockets?
 		return false;
 
+#ifdef HAVE_EPOLL
+	epollfd = epoll_create1(0);
+	for (s = 0; s < mysocketses && epollfd != -1; s++)
+	{
+		struct epoll_event ev;
+		ev.events = EPOLLIN;
+		ev.data.fd = mysockets[s];
+		if (epoll_ctl(epollfd, EPOLL_CTL_ADD, mysockets[s], &ev) == -1)
+		{
+			// select will do
+			close(epollfd);
+			epollfd = -1;
+		}
+	}
+#endif
+
 	s = 0;
 
 	// ip + udp
@@ -1149,6 +1201,13 @@ static void SOCK_CloseSocket(void)
 		}
 		mysockets[i] = ERRSOCKET;
 	}
+#ifdef HAVE_EPOLL
+	if (epollfd != -1)
+	{
+		close(epollfd);
+		epollfd = -1;
+	}
+#endif
 }
 #endif
 
@@ -1241,6 +1300,7 @@ static boolean SOCK_OpenSocket(void)
 	I_NetCloseSocket = SOCK_CloseSocket;
 	I_NetFreeNodenum = SOCK_FreeNodenum;
 	I_NetMakeNodewPort = SOCK_NetMakeNodewPort;
+	I_NetWaitForPacket = SOCK_WaitForPacket;
 
 #ifdef SELECTTEST
 	// seem like not work with libsocket : (
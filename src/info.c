@@ -21,7 +21,6 @@
 #include "z_zone.h"
 #include "d_player.h"
 #include "v_video.h" // V_*MAP constants
-#include "lzf.h"
 #ifdef HWRENDER
 #include "hardware/hw_light.h"
 #endif
@@ -21786,49 +21785,80 @@ void P_PatchInfoTables(void)
 }
 
 #ifdef ALLOW_RESETDATA
-static char *sprnamesbackup;
-static state_t *statesbackup;
-static mobjinfo_t *mobjinfobackup;
-static skincolor_t *skincolorsbackup;
-static size_t sprnamesbackupsize, statesbackupsize, mobjinfobackupsize, skincolorsbackupsize;
+// Copy-on-write journal of the info tables, for RESETDATA.
+// Nothing is copied at startup. The first time SOC or Lua is about to change
+// an entry, P_JournalInfo saves what it held, so that a reset only has to put
+// back the entries that were actually changed.
+typedef struct
+{
+	void *table;
+	size_t entrysize;
+	size_t numentries;
+	UINT8 *journaled; // one bit per entry
+	UINT8 *saved; // original contents of each journaled entry
+	UINT32 *indexes; // which entry each saved copy belongs to
+	size_t numsaved, maxsaved;
+} infojournal_t;
+
+static infojournal_t infojournal[NUMINFOTABLES] = {
+	{sprnames, sizeof (sprnames[0]), sizeof (sprnames) / sizeof (sprnames[0]), NULL, NULL, NULL, 0, 0},
+	{states, sizeof (states[0]), NUMSTATES, NULL, NULL, NULL, 0, 0},
+	{mobjinfo, sizeof (mobjinfo[0]), NUMMOBJTYPES, NULL, NULL, NULL, 0, 0},
+	{skincolors, sizeof (skincolors[0]), MAXSKINCOLORS, NULL, NULL, NULL, 0, 0},
+};
 #endif
 
 void P_BackupTables(void)
 {
 #ifdef ALLOW_RESETDATA
-	// Allocate buffers in size equal to that of the uncompressed data to begin with
-	sprnamesbackup = Z_Malloc(sizeof(sprnames), PU_STATIC, NULL);
-	statesbackup = Z_Malloc(sizeof(states), PU_STATIC, NULL);
-	mobjinfobackup = Z_Malloc(sizeof(mobjinfo), PU_STATIC, NULL);
-	skincolorsbackup = Z_Malloc(sizeof(skincolors), PU_STATIC, NULL);
-
-	// Sprite names
-	sprnamesbackupsize = lzf_compress(sprnames, sizeof(sprnames), sprnamesbackup, sizeof(sprnames));
-	if (sprnamesbackupsize > 0)
-		sprnamesbackup = Z_Realloc(sprnamesbackup, sprnamesbackupsize, PU_STATIC, NULL);
-	else
-		M_Memcpy(sprnamesbackup, sprnames, sizeof(sprnames));
-
-	// States
-	statesbackupsize = lzf_compress(states, sizeof(states), statesbackup, sizeof(states));
-	if (statesbackupsize > 0)
-		statesbackup = Z_Realloc(statesbackup, statesbackupsize, PU_STATIC, NULL);
-	else
-		M_Memcpy(statesbackup, states, sizeof(states));
-
-	// Mobj info
-	mobjinfobackupsize = lzf_compress(mobjinfo, sizeof(mobjinfo), mobjinfobackup, sizeof(mobjinfo));
-	if (mobjinfobackupsize > 0)
-		mobjinfobackup = Z_Realloc(mobjinfobackup, mobjinfobackupsize, PU_STATIC, NULL);
-	else
-		M_Memcpy(mobjinfobackup, mobjinfo, sizeof(mobjinfo));
-
-	//Skincolor info
-	skincolorsbackupsize = lzf_compress(skincolors, sizeof(skincolors), skincolorsbackup, sizeof(skincolors));
-	if (skincolorsbackupsize > 0)
-		skincolorsbackup = Z_Realloc(skincolorsbackup, skincolorsbackupsize, PU_STATIC, NULL);
-	else
-		M_Memcpy(skincolorsbackup, skincolors, sizeof(skincolors));
+	// Start journaling; whatever the tables hold now is what gets restored.
+	INT32 t;
+	for (t = 0; t < NUMINFOTABLES; t++)
+		infojournal[t].journaled = Z_Calloc((infojournal[t].numentries + 7) / 8, PU_STATIC, NULL);
+#endif
+}
+
+/** Saves an info table entry before it gets changed, unless it already was.
+  * Must be called by anything that changes sprnames, states, mobjinfo or
+  * skincolors after startup, or RESETDATA won't undo the change.
+  *
+  * \param table Which table the entry is in.
+  * \param index Index of the entry in that table.
+  */
+void P_JournalInfo(infotable_t table, size_t index)
+{
+#ifdef ALLOW_RESETDATA
+	infojournal_t *journal = &infojournal[table];
+
+	if (!journal->journaled || index >= journal->numentries
+		|| (journal->journaled[index >> 3] & (1 << (index & 7))))
+		return;
+
+	if (journal->numsaved == journal->maxsaved)
+	{
+		journal->maxsaved = journal->maxsaved ? journal->maxsaved * 2 : 64;
+		journal->saved = Z_Realloc(journal->saved, journal->maxsaved * journal->entrysize, PU_STATIC, NULL);
+		journal->indexes = Z_Realloc(journal->indexes, journal->maxsaved * sizeof (*journal->indexes), PU_STATIC, NULL);
+	}
+
+	M_Memcpy(journal->saved + journal->numsaved * journal->entrysize,
+		(UINT8 *)journal->table + index * journal->entrysize, journal->entrysize);
+	journal->indexes[journal->numsaved++] = (UINT32)index;
+	journal->journaled[index >> 3] |= 1 << (index & 7);
+#else
+	(void)table;
+	(void)index;
+#endif
+}
+
+// Returns how many entries of a table have been changed since startup or the last reset.
+size_t P_JournaledInfoCount(infotable_t table)
+{
+#ifdef ALLOW_RESETDATA
+	return infojournal[table].numsaved;
+#else
+	(void)table;
+	return 0;
 #endif
 }
 
@@ -21838,36 +21868,25 @@ void P_ResetData(INT32 flags)
 	(void)flags;
 	CONS_Alert(CONS_NOTICE, M_GetText("P_ResetData(): not supported in this build.\n"));
 #else
-	if (flags & 1)
-	{
-		if (sprnamesbackupsize > 0)
-			lzf_decompress(sprnamesbackup, sprnamesbackupsize, sprnames, sizeof(sprnames));
-		else
-			M_Memcpy(sprnames, sprnamesbackup, sizeof(sprnamesbackup));
-	}
-
-	if (flags & 2)
-	{
-		if (statesbackupsize > 0)
-			lzf_decompress(statesbackup, statesbackupsize, states, sizeof(states));
-		else
-			M_Memcpy(states, statesbackup, sizeof(statesbackup));
-	}
-
-	if (flags & 4)
-	{
-		if (mobjinfobackupsize > 0)
-			lzf_decompress(mobjinfobackup, mobjinfobackupsize, mobjinfo, sizeof(mobjinfo));
-		else
-			M_Memcpy(mobjinfo, mobjinfobackup, sizeof(mobjinfobackup));
-	}
+	INT32 t;
 
-	if (flags & 8)
+	// 1 = sprnames, 2 = states, 4 = mobjinfo, 8 = skincolors
+	for (t = 0; t < NUMINFOTABLES; t++)
 	{
-		if (skincolorsbackupsize > 0)
-			lzf_decompress(skincolorsbackup, skincolorsbackupsize, skincolors, sizeof(skincolors));
-		else
-			M_Memcpy(skincolors, skincolorsbackup, sizeof(skincolorsbackup));
+		infojournal_t *journal = &infojournal[t];
+		size_t i;
+
+		if (!(flags & (1 << t)))
+			continue;
+
+		for (i = 0; i < journal->numsaved; i++)
+		{
+			const UINT32 index = journal->indexes[i];
+			M_Memcpy((UINT8 *)journal->table + index * journal->entrysize,
+				journal->saved + i * journal->entrysize, journal->entrysize);
+			journal->journaled[index >> 3] &= ~(1 << (index & 7));
+		}
+		journal->numsaved = 0;
 	}
 #endif
 }
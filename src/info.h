@@ -5189,7 +5189,19 @@ extern mobjinfo_t mobjinfo[NUMMOBJTYPES];
 
 void P_PatchInfoTables(void);
 
+// Tables that RESETDATA can restore, in the order of its flag bits
+typedef enum
+{
+	INFOTABLE_SPRNAMES,
+	INFOTABLE_STATES,
+	INFOTABLE_MOBJINFO,
+	INFOTABLE_SKINCOLORS,
+	NUMINFOTABLES
+} infotable_t;
+
 void P_BackupTables(void);
+void P_JournalInfo(infotable_t table, size_t index);
+size_t P_JournaledInfoCount(infotable_t table);
 
 void P_ResetData(INT32 flags);
 
@@ -688,6 +688,7 @@ static int lib_setState(lua_State *L)
 		if (i >= NUMSTATES)
 			return luaL_error(L, "states[] index %d out of range (0 - %d)", i, NUMSTATES-1);
 		state = &states[i]; // get the state to assign to.
+		P_JournalInfo(INFOTABLE_STATES, i);
 	}
 	luaL_checktype(L, 2, LUA_TTABLE); // check that we've been passed a table.
 	lua_remove(L, 1); // pop state num, don't need it any more.
@@ -956,6 +957,8 @@ static int state_set(lua_State *L)
 	if (hook_cmd_running)
 		return luaL_error(L, "Do not alter states in CMD building code!");
 
+	P_JournalInfo(INFOTABLE_STATES, st - states);
+
 	if (fastcmp(field,"sprite")) {
 		value = luaL_checknumber(L, 3);
 		if (value < SPR_NULL || value >= NUMSPRITES)
@@ -1048,6 +1051,7 @@ static int lib_setMobjInfo(lua_State *L)
 		if (i >= NUMMOBJTYPES)
 			return luaL_error(L, "mobjinfo[] index %d out of range (0 - %d)", i, NUMMOBJTYPES-1);
 		info = &mobjinfo[i]; // get the mobjinfo to assign to.
+		P_JournalInfo(INFOTABLE_MOBJINFO, i);
 	}
 	luaL_checktype(L, 2, LUA_TTABLE); // check that we've been passed a table.
 	lua_remove(L, 1); // pop mobjtype num, don't need it any more.
@@ -1316,6 +1320,8 @@ static int mobjinfo_set(lua_State *L)
 	I_Assert(info != NULL);
 	I_Assert(info >= mobjinfo);
 
+	P_JournalInfo(INFOTABLE_MOBJINFO, info - mobjinfo);
+
 	switch (field)
 	{
 	case mobjinfo_doomednum:
@@ -1686,6 +1692,7 @@ static int lib_setSkinColor(lua_State *L)
 		if (!cnum || cnum >= numskincolors)
 			return luaL_error(L, "skincolors[] index %d out of range (1 - %d)", cnum, numskincolors-1);
 		info = &skincolors[cnum]; // get the skincolor to assign to.
+		P_JournalInfo(INFOTABLE_SKINCOLORS, cnum);
 	}
 	luaL_checktype(L, 2, LUA_TTABLE); // check that we've been passed a table.
 	lua_remove(L, 1); // pop skincolor num, don't need it any more.
@@ -1804,6 +1811,8 @@ static int skincolor_set(lua_State *L)
 	if (!cnum || cnum >= numskincolors)
 		return luaL_error(L, "skincolors[] index %d out of range (1 - %d)", cnum, numskincolors-1);
 
+	P_JournalInfo(INFOTABLE_SKINCOLORS, cnum);
+
 	if (fastcmp(field,"name")) {
 		const char* n = luaL_checkstring(L, 3);
 		strlcpy(info->name, n, MAXCOLORNAME+1);
@@ -1887,6 +1896,7 @@ static int colorramp_set(lua_State *L)
 		return luaL_error(L, "Do not alter skincolor_t in HUD rendering code!");
 	if (hook_cmd_running)
 		return luaL_error(L, "Do not alter skincolor_t in CMD building code!");
+	P_JournalInfo(INFOTABLE_SKINCOLORS, cnum);
 	colorramp[n] = i;
 	skincolor_modified[cnum] = true;
 	return 0;
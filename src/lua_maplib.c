@@ -2433,6 +2433,9 @@ static int slope_set(lua_State *L)
 	default:
 		return luaL_error(L, "pslope_t has no field named " LUA_QS ".", lua_tostring(L, 2));
 	case slope_o: { // o
+		vector3_t o;
+
+		// Read every component before changing anything, as any of them may error
 		luaL_checktype(L, 3, LUA_TTABLE);
 
 		lua_getfield(L, 3, "x");
@@ -2442,9 +2445,9 @@ static int slope_set(lua_State *L)
 			lua_rawgeti(L, 3, 1);
 		}
 		if (!lua_isnil(L, -1))
-			slope->o.x = luaL_checkfixed(L, -1);
+			o.x = luaL_checkfixed(L, -1);
 		else
-			slope->o.x = 0;
+			o.x = 0;
 		lua_pop(L, 1);
 
 		lua_getfield(L, 3, "y");
@@ -2454,9 +2457,9 @@ static int slope_set(lua_State *L)
 			lua_rawgeti(L, 3, 2);
 		}
 		if (!lua_isnil(L, -1))
-			slope->o.y = luaL_checkfixed(L, -1);
+			o.y = luaL_checkfixed(L, -1);
 		else
-			slope->o.y = 0;
+			o.y = 0;
 		lua_pop(L, 1);
 
 		lua_getfield(L, 3, "z");
@@ -2466,10 +2469,12 @@ static int slope_set(lua_State *L)
 			lua_rawgeti(L, 3, 3);
 		}
 		if (!lua_isnil(L, -1))
-			slope->o.z = luaL_checkfixed(L, -1);
+			o.z = luaL_checkfixed(L, -1);
 		else
-			slope->o.z = 0;
+			o.z = 0;
 		lua_pop(L, 1);
+
+		FV3_Copy(&slope->o, &o);
 		break;
 	}
 	case slope_zdelta: { // zdelta, this is temp until i figure out wtf to do
@@ -2494,6 +2499,7 @@ static int slope_set(lua_State *L)
 		P_CalculateSlopeNormal(slope);
 		break;
 	}
+	P_SlopeChanged(slope);
 	return 0;
 }
 
@@ -30,6 +30,9 @@
 #ifdef LUA_ALLOW_BYTECODE
 #include "d_netfil.h" // for LUA_DumpFile
 #endif
+#include "d_main.h" // srb2home
+#include "filesrch.h" // prunecachedirectory, touchcachefile
+#include "m_argv.h"
 
 #include "lua_script.h"
 #include "lua_libs.h"
@@ -37,6 +40,8 @@
 
 #include "doomstat.h"
 #include "g_state.h"
+#include "i_system.h" // I_GetPreciseTime
+#include "m_perfstats.h"
 
 lua_State *gL = NULL;
 
@@ -62,16 +67,46 @@ static lua_CFunction liblist[] = {
 	NULL
 };
 
+// Bytes gL has allocated since the last LUA_Step.
+// This is the "debt" the idle-time collector has to pay off.
+static size_t lua_gcdebt = 0;
+
+// Set once LUA_Step finishes a collection cycle, until the heap grows past
+// lua_gcbase * LUA_GCPAUSE; no idle time is spent collecting in between.
+static boolean lua_gcidle = false;
+static INT32 lua_gcbase = 0; // KB in use at the end of the last cycle
+
+#define LUA_GCHARDLIMIT 4 // heap growth at which Lua steps the collector by itself after all
+#define LUA_GCMINHEAP 1024 // KB, the smallest heap the limits are worked out from
+
+/** Keeps Lua's own collector from stepping inside allocations, which would
+  * pause the game in the middle of a tic. Collection is left to LUA_Step,
+  * except as a safety valve once the heap passes LUA_GCHARDLIMIT times its
+  * size at the end of the last cycle. Lua resets the threshold whenever it
+  * steps, so this has to be called again after every step.
+  */
+static void LUA_HoldCollector(void)
+{
+	INT32 limit = max(lua_gcbase, LUA_GCMINHEAP) * LUA_GCHARDLIMIT;
+
+	// Past the limit, Lua keeps driving collection until a cycle ends
+	if (lua_gc(gL, LUA_GCCOUNT, 0) < limit)
+		lua_gc(gL, LUA_GCSETTHRESHOLD, limit);
+}
+
 // Lua asks for memory using this.
+// ud points to the debt counter for gL, and is NULL for other states.
 static void *LUA_Alloc(void *ud, void *ptr, size_t osize, size_t nsize)
 {
-	(void)ud;
 	if (nsize == 0) {
 		if (osize != 0)
 			Z_Free(ptr);
 		return NULL;
-	} else
+	} else {
+		if (ud && nsize > osize)
+			*(size_t *)ud += nsize - osize;
 		return Z_Realloc(ptr, nsize, PU_LUA, NULL);
+	}
 }
 
 // Panic function Lua calls when there's an unprotected error.
@@ -150,338 +185,512 @@ int LUA_Call(lua_State *L, int nargs, int nresults, int errorhandlerindex)
 	return err;
 }
 
+// The built-in globals handled by LUA_PushGlobals and LUA_CheckGlobals.
+// Every read of a global that isn't in _G ends up here, so names are found
+// through a hash instead of being compared against each of these in turn.
+enum
+{
+	LG_GAMEMAP,
+	LG_UDMF,
+	LG_MAPTOL,
+	LG_ULTIMATEMODE,
+	LG_MARIOMODE,
+	LG_TWODLEVEL,
+	LG_CIRCUITMAP,
+	LG_STOPPEDCLOCK,
+	LG_NETGAME,
+	LG_MULTIPLAYER,
+	LG_MODEATTACKING,
+	LG_METALRECORDING,
+	LG_SPLITSCREEN,
+	LG_GAMECOMPLETE,
+	LG_MARATHONMODE,
+	LG_DEVPARM,
+	LG_MODIFIEDGAME,
+	LG_USEDCHEATS,
+	LG_MENUACTIVE,
+	LG_PAUSED,
+	LG_BLUESCORE,
+	LG_REDSCORE,
+	LG_TIMELIMIT,
+	LG_POINTLIMIT,
+	LG_REDFLAG,
+	LG_BLUEFLAG,
+	LG_RFLAGPOINT,
+	LG_BFLAGPOINT,
+	LG_SPSTAGE_START,
+	LG_SPMARATHON_START,
+	LG_SSTAGE_START,
+	LG_SSTAGE_END,
+	LG_SMPSTAGE_START,
+	LG_SMPSTAGE_END,
+	LG_TITLEMAP,
+	LG_TITLEMAPINACTION,
+	LG_BOOTMAP,
+	LG_TUTORIALMAP,
+	LG_TUTORIALMODE,
+	LG_SKINCOLOR_REDTEAM,
+	LG_SKINCOLOR_BLUETEAM,
+	LG_SKINCOLOR_REDRING,
+	LG_SKINCOLOR_BLUERING,
+	LG_INVULNTICS,
+	LG_SNEAKERTICS,
+	LG_FLASHINGTICS,
+	LG_TAILSFLYTICS,
+	LG_UNDERWATERTICS,
+	LG_SPACETIMETICS,
+	LG_EXTRALIFETICS,
+	LG_NIGHTSLINKTICS,
+	LG_GAMEOVERTICS,
+	LG_AMMOREMOVALTICS,
+	LG_USE1UPSOUND,
+	LG_MAXXTRALIFE,
+	LG_USECONTINUES,
+	LG_SHAREEMBLEMS,
+	LG_GAMETYPE,
+	LG_GAMETYPERULES,
+	LG_LEVELTIME,
+	LG_SSTIMER,
+	LG_CURWEATHER,
+	LG_GLOBALWEATHER,
+	LG_LEVELSKYNUM,
+	LG_GLOBALLEVELSKYNUM,
+	LG_MAPMUSNAME,
+	LG_MAPMUSFLAGS,
+	LG_MAPMUSPOSITION,
+	LG_CONSOLEPLAYER,
+	LG_DISPLAYPLAYER,
+	LG_SECONDARYDISPLAYPLAYER,
+	LG_ISSERVER,
+	LG_ISDEDICATEDSERVER,
+	LG_SERVER,
+	LG_EMERALDS,
+	LG_GRAVITY,
+	LG_VERSION,
+	LG_SUBVERSION,
+	LG_VERSIONSTRING,
+	LG_TOKEN,
+	LG_GAMESTATE,
+	LG_STAGEFAILED,
+	LG_MOUSE,
+	LG_MOUSE2,
+	LG_CAMERA,
+	LG_CAMERA2,
+	NUMLUAGLOBALS
+};
+
+static const char *const luaglobalnames[NUMLUAGLOBALS] = {
+	"gamemap", "udmf", "maptol", "ultimatemode", "mariomode", "twodlevel",
+	"circuitmap", "stoppedclock", "netgame", "multiplayer", "modeattacking",
+	"metalrecording", "splitscreen", "gamecomplete", "marathonmode", "devparm",
+	"modifiedgame", "usedCheats", "menuactive", "paused", "bluescore", "redscore",
+	"timelimit", "pointlimit", "redflag", "blueflag", "rflagpoint", "bflagpoint",
+	"spstage_start", "spmarathon_start", "sstage_start", "sstage_end",
+	"smpstage_start", "smpstage_end", "titlemap", "titlemapinaction", "bootmap",
+	"tutorialmap", "tutorialmode", "skincolor_redteam", "skincolor_blueteam",
+	"skincolor_redring", "skincolor_bluering", "invulntics", "sneakertics",
+	"flashingtics", "tailsflytics", "underwatertics", "spacetimetics",
+	"extralifetics", "nightslinktics", "gameovertics", "ammoremovaltics",
+	"use1upSound", "maxXtraLife", "useContinues", "shareEmblems", "gametype",
+	"gametyperules", "leveltime", "sstimer", "curWeather", "globalweather",
+	"levelskynum", "globallevelskynum", "mapmusname", "mapmusflags",
+	"mapmusposition", "consoleplayer", "displayplayer", "secondarydisplayplayer",
+	"isserver", "isdedicatedserver", "server", "emeralds", "gravity", "VERSION",
+	"SUBVERSION", "VERSIONSTRING", "token", "gamestate", "stagefailed", "mouse",
+	"mouse2", "camera", "camera2"
+};
+
+#define LUAGLOBALHASHSIZE 512 // power of two, well above NUMLUAGLOBALS
+
+static INT16 luaglobalhash[LUAGLOBALHASHSIZE]; // global number + 1, 0 if empty
+
+static UINT32 LUA_HashGlobalName(const char *word)
+{
+	UINT32 hash = 2166136261u; // FNV-1a
+	for (; *word; word++)
+		hash = (hash ^ (UINT8)*word) * 16777619u;
+	return hash;
+}
+
+// Returns the LG_ number of a built-in global's name, or -1.
+static INT32 LUA_GlobalNum(const char *word)
+{
+	static boolean hashed = false;
+	UINT32 slot;
+	INT32 i;
+
+	if (!hashed)
+	{
+		for (i = 0; i < NUMLUAGLOBALS; i++)
+		{
+			for (slot = LUA_HashGlobalName(luaglobalnames[i]); luaglobalhash[slot & (LUAGLOBALHASHSIZE-1)]; slot++)
+				;
+			luaglobalhash[slot & (LUAGLOBALHASHSIZE-1)] = (INT16)(i + 1);
+		}
+		hashed = true;
+	}
+
+	for (slot = LUA_HashGlobalName(word); (i = luaglobalhash[slot & (LUAGLOBALHASHSIZE-1)]); slot++)
+	{
+		if (fastcmp(word, luaglobalnames[i - 1]))
+			return i - 1;
+	}
+
+	return -1;
+}
+
 // Moved here from lib_getenum.
 int LUA_PushGlobals(lua_State *L, const char *word)
 {
-	if (fastcmp(word,"gamemap")) {
-		lua_pushinteger(L, gamemap);
-		return 1;
-	} else if (fastcmp(word,"udmf")) {
-		lua_pushboolean(L, udmf);
-		return 1;
-	} else if (fastcmp(word,"maptol")) {
-		lua_pushinteger(L, maptol);
-		return 1;
-	} else if (fastcmp(word,"ultimatemode")) {
-		lua_pushboolean(L, ultimatemode != 0);
-		return 1;
-	} else if (fastcmp(word,"mariomode")) {
-		lua_pushboolean(L, mariomode != 0);
-		return 1;
-	} else if (fastcmp(word,"twodlevel")) {
-		lua_pushboolean(L, twodlevel != 0);
-		return 1;
-	} else if (fastcmp(word,"circuitmap")) {
-		lua_pushboolean(L, circuitmap);
-		return 1;
-	} else if (fastcmp(word,"stoppedclock")) {
-		lua_pushboolean(L, stoppedclock);
-		return 1;
-	} else if (fastcmp(word,"netgame")) {
-		lua_pushboolean(L, netgame);
-		return 1;
-	} else if (fastcmp(word,"multiplayer")) {
-		lua_pushboolean(L, multiplayer);
-		return 1;
-	} else if (fastcmp(word,"modeattacking")) {
-		lua_pushboolean(L, modeattacking);
-		return 1;
-	} else if (fastcmp(word,"metalrecording")) {
-		lua_pushboolean(L, metalrecording);
-		return 1;
-	} else if (fastcmp(word,"splitscreen")) {
-		lua_pushboolean(L, splitscreen);
-		return 1;
-	} else if (fastcmp(word,"gamecomplete")) {
-		lua_pushboolean(L, (gamecomplete != 0));
-		return 1;
-	} else if (fastcmp(word,"marathonmode")) {
-		lua_pushinteger(L, marathonmode);
-		return 1;
-	} else if (fastcmp(word,"devparm")) {
-		lua_pushboolean(L, devparm);
-		return 1;
-	} else if (fastcmp(word,"modifiedgame")) {
-		lua_pushboolean(L, modifiedgame && !savemoddata);
-		return 1;
-	} else if (fastcmp(word,"usedCheats")) {
-		lua_pushboolean(L, usedCheats);
-		return 1;
-	} else if (fastcmp(word,"menuactive")) {
-		lua_pushboolean(L, menuactive);
-		return 1;
-	} else if (fastcmp(word,"paused")) {
-		lua_pushboolean(L, paused);
-		return 1;
-	} else if (fastcmp(word,"bluescore")) {
-		lua_pushinteger(L, bluescore);
-		return 1;
-	} else if (fastcmp(word,"redscore")) {
-		lua_pushinteger(L, redscore);
-		return 1;
-	} else if (fastcmp(word,"timelimit")) {
-		lua_pushinteger(L, cv_timelimit.value);
-		return 1;
-	} else if (fastcmp(word,"pointlimit")) {
-		lua_pushinteger(L, cv_pointlimit.value);
-		return 1;
-	} else if (fastcmp(word, "redflag")) {
-		LUA_PushUserdata(L, redflag, META_MOBJ);
-		return 1;
-	} else if (fastcmp(word, "blueflag")) {
-		LUA_PushUserdata(L, blueflag, META_MOBJ);
-		return 1;
-	} else if (fastcmp(word, "rflagpoint")) {
-		LUA_PushUserdata(L, rflagpoint, META_MAPTHING);
-		return 1;
-	} else if (fastcmp(word, "bflagpoint")) {
-		LUA_PushUserdata(L, bflagpoint, META_MAPTHING);
-		return 1;
-	// begin map vars
-	} else if (fastcmp(word,"spstage_start")) {
-		lua_pushinteger(L, spstage_start);
-		return 1;
-	} else if (fastcmp(word,"spmarathon_start")) {
-		lua_pushinteger(L, spmarathon_start);
-		return 1;
-	} else if (fastcmp(word,"sstage_start")) {
-		lua_pushinteger(L, sstage_start);
-		return 1;
-	} else if (fastcmp(word,"sstage_end")) {
-		lua_pushinteger(L, sstage_end);
-		return 1;
-	} else if (fastcmp(word,"smpstage_start")) {
-		lua_pushinteger(L, smpstage_start);
-		return 1;
-	} else if (fastcmp(word,"smpstage_end")) {
-		lua_pushinteger(L, smpstage_end);
-		return 1;
-	} else if (fastcmp(word,"titlemap")) {
-		lua_pushinteger(L, titlemap);
-		return 1;
-	} else if (fastcmp(word,"titlemapinaction")) {
-		lua_pushboolean(L, (titlemapinaction != TITLEMAP_OFF));
-		return 1;
-	} else if (fastcmp(word,"bootmap")) {
-		lua_pushinteger(L, bootmap);
-		return 1;
-	} else if (fastcmp(word,"tutorialmap")) {
-		lua_pushinteger(L, tutorialmap);
-		return 1;
-	} else if (fastcmp(word,"tutorialmode")) {
-		lua_pushboolean(L, tutorialmode);
-		return 1;
-	// end map vars
-	// begin CTF colors
-	} else if (fastcmp(word,"skincolor_redteam")) {
-		lua_pushinteger(L, skincolor_redteam);
-		return 1;
-	} else if (fastcmp(word,"skincolor_blueteam")) {
-		lua_pushinteger(L, skincolor_blueteam);
-		return 1;
-	} else if (fastcmp(word,"skincolor_redring")) {
-		lua_pushinteger(L, skincolor_redring);
-		return 1;
-	} else if (fastcmp(word,"skincolor_bluering")) {
-		lua_pushinteger(L, skincolor_bluering);
-		return 1;
-	// end CTF colors
-	// begin timers
-	} else if (fastcmp(word,"invulntics")) {
-		lua_pushinteger(L, invulntics);
-		return 1;
-	} else if (fastcmp(word,"sneakertics")) {
-		lua_pushinteger(L, sneakertics);
-		return 1;
-	} else if (fastcmp(word,"flashingtics")) {
-		lua_pushinteger(L, flashingtics);
-		return 1;
-	} else if (fastcmp(word,"tailsflytics")) {
-		lua_pushinteger(L, tailsflytics);
-		return 1;
-	} else if (fastcmp(word,"underwatertics")) {
-		lua_pushinteger(L, underwatertics);
-		return 1;
-	} else if (fastcmp(word,"spacetimetics")) {
-		lua_pushinteger(L, spacetimetics);
-		return 1;
-	} else if (fastcmp(word,"extralifetics")) {
-		lua_pushinteger(L, extralifetics);
-		return 1;
-	} else if (fastcmp(word,"nightslinktics")) {
-		lua_pushinteger(L, nightslinktics);
-		return 1;
-	} else if (fastcmp(word,"gameovertics")) {
-		lua_pushinteger(L, gameovertics);
-		return 1;
-	} else if (fastcmp(word,"ammoremovaltics")) {
-		lua_pushinteger(L, ammoremovaltics);
-		return 1;
-	// end timers
-	} else if (fastcmp(word,"use1upSound")) {
-		lua_pushinteger(L, use1upSound);
-		return 1;
-	} else if (fastcmp(word,"maxXtraLife")) {
-		lua_pushinteger(L, maxXtraLife);
-		return 1;
-	} else if (fastcmp(word,"useContinues")) {
-		lua_pushinteger(L, useContinues);
-		return 1;
-	} else if (fastcmp(word,"shareEmblems")) {
-		lua_pushinteger(L, shareEmblems);
-		return 1;
-	} else if (fastcmp(word,"gametype")) {
-		lua_pushinteger(L, gametype);
-		return 1;
-	} else if (fastcmp(word,"gametyperules")) {
-		lua_pushinteger(L, gametyperules);
-		return 1;
-	} else if (fastcmp(word,"leveltime")) {
-		lua_pushinteger(L, leveltime);
-		return 1;
-	} else if (fastcmp(word,"sstimer")) {
-		lua_pushinteger(L, sstimer);
-		return 1;
-	} else if (fastcmp(word,"curWeather")) {
-		lua_pushinteger(L, curWeather);
-		return 1;
-	} else if (fastcmp(word,"globalweather")) {
-		lua_pushinteger(L, globalweather);
-		return 1;
-	} else if (fastcmp(word,"levelskynum")) {
-		lua_pushinteger(L, levelskynum);
-		return 1;
-	} else if (fastcmp(word,"globallevelskynum")) {
-		lua_pushinteger(L, globallevelskynum);
-		return 1;
-	} else if (fastcmp(word,"mapmusname")) {
-		lua_pushstring(L, mapmusname);
-		return 1;
-	} else if (fastcmp(word,"mapmusflags")) {
-		lua_pushinteger(L, mapmusflags);
-		return 1;
-	} else if (fastcmp(word,"mapmusposition")) {
-		lua_pushinteger(L, mapmusposition);
-		return 1;
-	// local player variables, by popular request
-	} else if (fastcmp(word,"consoleplayer")) { // player controlling console (aka local player 1)
-		if (!addedtogame || consoleplayer < 0 || !playeringame[consoleplayer])
-			return 0;
-		LUA_PushUserdata(L, &players[consoleplayer], META_PLAYER);
-		return 1;
-	} else if (fastcmp(word,"displayplayer")) { // player visible on screen (aka display player 1)
-		if (displayplayer < 0 || !playeringame[displayplayer])
-			return 0;
-		LUA_PushUserdata(L, &players[displayplayer], META_PLAYER);
-		return 1;
-	} else if (fastcmp(word,"secondarydisplayplayer")) { // local/display player 2, for splitscreen
-		if (!splitscreen || secondarydisplayplayer < 0 || !playeringame[secondarydisplayplayer])
-			return 0;
-		LUA_PushUserdata(L, &players[secondarydisplayplayer], META_PLAYER);
-		return 1;
-	} else if (fastcmp(word,"isserver")) {
-		lua_pushboolean(L, server);
-		return 1;
-	} else if (fastcmp(word,"isdedicatedserver")) {
-		lua_pushboolean(L, dedicated);
-		return 1;
-	// end local player variables
-	} else if (fastcmp(word,"server")) {
-		if ((!multiplayer || !netgame) && !playeringame[serverplayer])
-			return 0;
-		LUA_PushUserdata(L, &players[serverplayer], META_PLAYER);
-		return 1;
-	} else if (fastcmp(word,"emeralds")) {
-		lua_pushinteger(L, emeralds);
-		return 1;
-	} else if (fastcmp(word,"gravity")) {
-		lua_pushinteger(L, gravity);
-		return 1;
-	} else if (fastcmp(word,"VERSION")) {
-		lua_pushinteger(L, VERSION);
-		return 1;
-	} else if (fastcmp(word,"SUBVERSION")) {
-		lua_pushinteger(L, SUBVERSION);
-		return 1;
-	} else if (fastcmp(word,"VERSIONSTRING")) {
-		lua_pushstring(L, VERSIONSTRING);
-		return 1;
-	} else if (fastcmp(word, "token")) {
-		lua_pushinteger(L, token);
-		return 1;
-	} else if (fastcmp(word, "gamestate")) {
-		lua_pushinteger(L, gamestate);
-		return 1;
-	} else if (fastcmp(word, "stagefailed")) {
-		lua_pushboolean(L, stagefailed);
-		return 1;
-	} else if (fastcmp(word, "mouse")) {
-		LUA_PushUserdata(L, &mouse, META_MOUSE);
-		return 1;
-	} else if (fastcmp(word, "mouse2")) {
-		LUA_PushUserdata(L, &mouse2, META_MOUSE);
-		return 1;
-	} else if (fastcmp(word, "camera")) {
-		LUA_PushUserdata(L, &camera, META_CAMERA);
-		return 1;
-	} else if (fastcmp(word, "camera2")) {
-		if (!splitscreen)
+	switch (LUA_GlobalNum(word))
+	{
+		case LG_GAMEMAP:
+			lua_pushinteger(L, gamemap);
+			return 1;
+		case LG_UDMF:
+			lua_pushboolean(L, udmf);
+			return 1;
+		case LG_MAPTOL:
+			lua_pushinteger(L, maptol);
+			return 1;
+		case LG_ULTIMATEMODE:
+			lua_pushboolean(L, ultimatemode != 0);
+			return 1;
+		case LG_MARIOMODE:
+			lua_pushboolean(L, mariomode != 0);
+			return 1;
+		case LG_TWODLEVEL:
+			lua_pushboolean(L, twodlevel != 0);
+			return 1;
+		case LG_CIRCUITMAP:
+			lua_pushboolean(L, circuitmap);
+			return 1;
+		case LG_STOPPEDCLOCK:
+			lua_pushboolean(L, stoppedclock);
+			return 1;
+		case LG_NETGAME:
+			lua_pushboolean(L, netgame);
+			return 1;
+		case LG_MULTIPLAYER:
+			lua_pushboolean(L, multiplayer);
+			return 1;
+		case LG_MODEATTACKING:
+			lua_pushboolean(L, modeattacking);
+			return 1;
+		case LG_METALRECORDING:
+			lua_pushboolean(L, metalrecording);
+			return 1;
+		case LG_SPLITSCREEN:
+			lua_pushboolean(L, splitscreen);
+			return 1;
+		case LG_GAMECOMPLETE:
+			lua_pushboolean(L, (gamecomplete != 0));
+			return 1;
+		case LG_MARATHONMODE:
+			lua_pushinteger(L, marathonmode);
+			return 1;
+		case LG_DEVPARM:
+			lua_pushboolean(L, devparm);
+			return 1;
+		case LG_MODIFIEDGAME:
+			lua_pushboolean(L, modifiedgame && !savemoddata);
+			return 1;
+		case LG_USEDCHEATS:
+			lua_pushboolean(L, usedCheats);
+			return 1;
+		case LG_MENUACTIVE:
+			lua_pushboolean(L, menuactive);
+			return 1;
+		case LG_PAUSED:
+			lua_pushboolean(L, paused);
+			return 1;
+		case LG_BLUESCORE:
+			lua_pushinteger(L, bluescore);
+			return 1;
+		case LG_REDSCORE:
+			lua_pushinteger(L, redscore);
+			return 1;
+		case LG_TIMELIMIT:
+			lua_pushinteger(L, cv_timelimit.value);
+			return 1;
+		case LG_POINTLIMIT:
+			lua_pushinteger(L, cv_pointlimit.value);
+			return 1;
+		case LG_REDFLAG:
+			LUA_PushUserdata(L, redflag, META_MOBJ);
+			return 1;
+		case LG_BLUEFLAG:
+			LUA_PushUserdata(L, blueflag, META_MOBJ);
+			return 1;
+		case LG_RFLAGPOINT:
+			LUA_PushUserdata(L, rflagpoint, META_MAPTHING);
+			return 1;
+		case LG_BFLAGPOINT:
+			LUA_PushUserdata(L, bflagpoint, META_MAPTHING);
+			return 1;
+		// begin map vars
+		case LG_SPSTAGE_START:
+			lua_pushinteger(L, spstage_start);
+			return 1;
+		case LG_SPMARATHON_START:
+			lua_pushinteger(L, spmarathon_start);
+			return 1;
+		case LG_SSTAGE_START:
+			lua_pushinteger(L, sstage_start);
+			return 1;
+		case LG_SSTAGE_END:
+			lua_pushinteger(L, sstage_end);
+			return 1;
+		case LG_SMPSTAGE_START:
+			lua_pushinteger(L, smpstage_start);
+			return 1;
+		case LG_SMPSTAGE_END:
+			lua_pushinteger(L, smpstage_end);
+			return 1;
+		case LG_TITLEMAP:
+			lua_pushinteger(L, titlemap);
+			return 1;
+		case LG_TITLEMAPINACTION:
+			lua_pushboolean(L, (titlemapinaction != TITLEMAP_OFF));
+			return 1;
+		case LG_BOOTMAP:
+			lua_pushinteger(L, bootmap);
+			return 1;
+		case LG_TUTORIALMAP:
+			lua_pushinteger(L, tutorialmap);
+			return 1;
+		case LG_TUTORIALMODE:
+			lua_pushboolean(L, tutorialmode);
+			return 1;
+		// end map vars
+		// begin CTF colors
+		case LG_SKINCOLOR_REDTEAM:
+			lua_pushinteger(L, skincolor_redteam);
+			return 1;
+		case LG_SKINCOLOR_BLUETEAM:
+			lua_pushinteger(L, skincolor_blueteam);
+			return 1;
+		case LG_SKINCOLOR_REDRING:
+			lua_pushinteger(L, skincolor_redring);
+			return 1;
+		case LG_SKINCOLOR_BLUERING:
+			lua_pushinteger(L, skincolor_bluering);
+			return 1;
+		// end CTF colors
+		// begin timers
+		case LG_INVULNTICS:
+			lua_pushinteger(L, invulntics);
+			return 1;
+		case LG_SNEAKERTICS:
+			lua_pushinteger(L, sneakertics);
+			return 1;
+		case LG_FLASHINGTICS:
+			lua_pushinteger(L, flashingtics);
+			return 1;
+		case LG_TAILSFLYTICS:
+			lua_pushinteger(L, tailsflytics);
+			return 1;
+		case LG_UNDERWATERTICS:
+			lua_pushinteger(L, underwatertics);
+			return 1;
+		case LG_SPACETIMETICS:
+			lua_pushinteger(L, spacetimetics);
+			return 1;
+		case LG_EXTRALIFETICS:
+			lua_pushinteger(L, extralifetics);
+			return 1;
+		case LG_NIGHTSLINKTICS:
+			lua_pushinteger(L, nightslinktics);
+			return 1;
+		case LG_GAMEOVERTICS:
+			lua_pushinteger(L, gameovertics);
+			return 1;
+		case LG_AMMOREMOVALTICS:
+			lua_pushinteger(L, ammoremovaltics);
+			return 1;
+		// end timers
+		case LG_USE1UPSOUND:
+			lua_pushinteger(L, use1upSound);
+			return 1;
+		case LG_MAXXTRALIFE:
+			lua_pushinteger(L, maxXtraLife);
+			return 1;
+		case LG_USECONTINUES:
+			lua_pushinteger(L, useContinues);
+			return 1;
+		case LG_SHAREEMBLEMS:
+			lua_pushinteger(L, shareEmblems);
+			return 1;
+		case LG_GAMETYPE:
+			lua_pushinteger(L, gametype);
+			return 1;
+		case LG_GAMETYPERULES:
+			lua_pushinteger(L, gametyperules);
+			return 1;
+		case LG_LEVELTIME:
+			lua_pushinteger(L, leveltime);
+			return 1;
+		case LG_SSTIMER:
+			lua_pushinteger(L, sstimer);
+			return 1;
+		case LG_CURWEATHER:
+			lua_pushinteger(L, curWeather);
+			return 1;
+		case LG_GLOBALWEATHER:
+			lua_pushinteger(L, globalweather);
+			return 1;
+		case LG_LEVELSKYNUM:
+			lua_pushinteger(L, levelskynum);
+			return 1;
+		case LG_GLOBALLEVELSKYNUM:
+			lua_pushinteger(L, globallevelskynum);
+			return 1;
+		case LG_MAPMUSNAME:
+			lua_pushstring(L, mapmusname);
+			return 1;
+		case LG_MAPMUSFLAGS:
+			lua_pushinteger(L, mapmusflags);
+			return 1;
+		case LG_MAPMUSPOSITION:
+			lua_pushinteger(L, mapmusposition);
+			return 1;
+		// local player variables, by popular request
+		case LG_CONSOLEPLAYER: // player controlling console (aka local player 1)
+			if (!addedtogame || consoleplayer < 0 || !playeringame[consoleplayer])
+				return 0;
+			LUA_PushUserdata(L, &players[consoleplayer], META_PLAYER);
+			return 1;
+		case LG_DISPLAYPLAYER: // player visible on screen (aka display player 1)
+			if (displayplayer < 0 || !playeringame[displayplayer])
+				return 0;
+			LUA_PushUserdata(L, &players[displayplayer], META_PLAYER);
+			return 1;
+		case LG_SECONDARYDISPLAYPLAYER: // local/display player 2, for splitscreen
+			if (!splitscreen || secondarydisplayplayer < 0 || !playeringame[secondarydisplayplayer])
+				return 0;
+			LUA_PushUserdata(L, &players[secondarydisplayplayer], META_PLAYER);
+			return 1;
+		case LG_ISSERVER:
+			lua_pushboolean(L, server);
+			return 1;
+		case LG_ISDEDICATEDSERVER:
+			lua_pushboolean(L, dedicated);
+			return 1;
+		// end local player variables
+		case LG_SERVER:
+			if ((!multiplayer || !netgame) && !playeringame[serverplayer])
+				return 0;
+			LUA_PushUserdata(L, &players[serverplayer], META_PLAYER);
+			return 1;
+		case LG_EMERALDS:
+			lua_pushinteger(L, emeralds);
+			return 1;
+		case LG_GRAVITY:
+			lua_pushinteger(L, gravity);
+			return 1;
+		case LG_VERSION:
+			lua_pushinteger(L, VERSION);
+			return 1;
+		case LG_SUBVERSION:
+			lua_pushinteger(L, SUBVERSION);
+			return 1;
+		case LG_VERSIONSTRING:
+			lua_pushstring(L, VERSIONSTRING);
+			return 1;
+		case LG_TOKEN:
+			lua_pushinteger(L, token);
+			return 1;
+		case LG_GAMESTATE:
+			lua_pushinteger(L, gamestate);
+			return 1;
+		case LG_STAGEFAILED:
+			lua_pushboolean(L, stagefailed);
+			return 1;
+		case LG_MOUSE:
+			LUA_PushUserdata(L, &mouse, META_MOUSE);
+			return 1;
+		case LG_MOUSE2:
+			LUA_PushUserdata(L, &mouse2, META_MOUSE);
+			return 1;
+		case LG_CAMERA:
+			LUA_PushUserdata(L, &camera, META_CAMERA);
+			return 1;
+		case LG_CAMERA2:
+			if (!splitscreen)
+				return 0;
+			LUA_PushUserdata(L, &camera2, META_CAMERA);
+			return 1;
+		default:
 			return 0;
-		LUA_PushUserdata(L, &camera2, META_CAMERA);
-		return 1;
 	}
-	return 0;
 }
 
 // See the above.
 int LUA_CheckGlobals(lua_State *L, const char *word)
 {
-	if (fastcmp(word, "redscore"))
-		redscore = (UINT32)luaL_checkinteger(L, 2);
-	else if (fastcmp(word, "bluescore"))
-		bluescore = (UINT32)luaL_checkinteger(L, 2);
-	else if (fastcmp(word, "skincolor_redteam"))
-		skincolor_redteam = (UINT16)luaL_checkinteger(L, 2);
-	else if (fastcmp(word, "skincolor_blueteam"))
-		skincolor_blueteam = (UINT16)luaL_checkinteger(L, 2);
-	else if (fastcmp(word, "skincolor_redring"))
-		skincolor_redring = (UINT16)luaL_checkinteger(L, 2);
-	else if (fastcmp(word, "skincolor_bluering"))
-		skincolor_bluering = (UINT16)luaL_checkinteger(L, 2);
-	else if (fastcmp(word, "emeralds"))
-		emeralds = (UINT16)luaL_checkinteger(L, 2);
-	else if (fastcmp(word, "token"))
-		token = (UINT32)luaL_checkinteger(L, 2);
-	else if (fastcmp(word, "gravity"))
-		gravity = (fixed_t)luaL_checkinteger(L, 2);
-	else if (fastcmp(word, "stoppedclock"))
-		stoppedclock = luaL_checkboolean(L, 2);
-	else if (fastcmp(word, "displayplayer"))
+	switch (LUA_GlobalNum(word))
 	{
-		player_t *player = *((player_t **)luaL_checkudata(L, 2, META_PLAYER));
+		case LG_REDSCORE:
+			redscore = (UINT32)luaL_checkinteger(L, 2);
+			break;
+		case LG_BLUESCORE:
+			bluescore = (UINT32)luaL_checkinteger(L, 2);
+			break;
+		case LG_SKINCOLOR_REDTEAM:
+			skincolor_redteam = (UINT16)luaL_checkinteger(L, 2);
+			break;
+		case LG_SKINCOLOR_BLUETEAM:
+			skincolor_blueteam = (UINT16)luaL_checkinteger(L, 2);
+			break;
+		case LG_SKINCOLOR_REDRING:
+			skincolor_redring = (UINT16)luaL_checkinteger(L, 2);
+			break;
+		case LG_SKINCOLOR_BLUERING:
+			skincolor_bluering = (UINT16)luaL_checkinteger(L, 2);
+			break;
+		case LG_EMERALDS:
+			emeralds = (UINT16)luaL_checkinteger(L, 2);
+			break;
+		case LG_TOKEN:
+			token = (UINT32)luaL_checkinteger(L, 2);
+			break;
+		case LG_GRAVITY:
+			gravity = (fixed_t)luaL_checkinteger(L, 2);
+			break;
+		case LG_STOPPEDCLOCK:
+			stoppedclock = luaL_checkboolean(L, 2);
+			break;
+		case LG_DISPLAYPLAYER:
+		{
+			player_t *player = *((player_t **)luaL_checkudata(L, 2, META_PLAYER));
 
-		if (player)
-			displayplayer = player - players;
-	}
-	else if (fastcmp(word, "mapmusname"))
-	{
-		size_t strlength;
-		const char *str = luaL_checklstring(L, 2, &strlength);
+			if (player)
+				displayplayer = player - players;
+			break;
+		}
+		case LG_MAPMUSNAME:
+		{
+			size_t strlength;
+			const char *str = luaL_checklstring(L, 2, &strlength);
 
-		if (strlength > 6)
-			return luaL_error(L, "string length out of range (maximum 6 characters)");
+			if (strlength > 6)
+				return luaL_error(L, "string length out of range (maximum 6 characters)");
 
-		if (strlen(str) < strlength)
-			return luaL_error(L, "string must not contain embedded zeros!");
+			if (strlen(str) < strlength)
+				return luaL_error(L, "string must not contain embedded zeros!");
 
-		strlcpy(mapmusname, str, sizeof mapmusname);
+			strlcpy(mapmusname, str, sizeof mapmusname);
+			break;
+		}
+		case LG_MAPMUSFLAGS:
+			mapmusflags = (UINT16)luaL_checkinteger(L, 2);
+			break;
+		case LG_STAGEFAILED:
+			stagefailed = luaL_checkboolean(L, 2);
+			break;
+		default:
+			return 0;
 	}
-	else if (fastcmp(word, "mapmusflags"))
-		mapmusflags = (UINT16)luaL_checkinteger(L, 2);
-	else if (fastcmp(word, "stagefailed"))
-		stagefailed = luaL_checkboolean(L, 2);
-	else
-		return 0;
 
 	// Global variable set, so return and don't error.
 	return 1;
@@ -549,11 +758,13 @@ static void LUA_ClearState(void)
 	if (gL)
 		lua_close(gL);
 	gL = NULL;
+	lua_gcidle = false;
+	lua_gcbase = 0;
 
 	CONS_Printf(M_GetText("Pardon me while I initialize the Lua scripting interface...\n"));
 
 	// allocate state
-	L = lua_newstate(LUA_Alloc, NULL);
+	L = lua_newstate(LUA_Alloc, &lua_gcdebt);
 	lua_atpanic(L, LUA_Panic);
 
 	// open base libraries
@@ -584,6 +795,7 @@ static void LUA_ClearState(void)
 
 	// lua state is ready!
 	gL = L;
+	LUA_HoldCollector();
 }
 
 #ifdef _DEBUG
@@ -601,10 +813,224 @@ void LUA_ClearExtVars(void)
 // (i.e. they were called in hooks or coroutines etc)
 INT32 lua_lumploading = 0;
 
+// must match lua_Writer
+static int dumpWriter(lua_State *L, const void *p, size_t sz, void *ud)
+{
+	FILE *handle = (FILE*)ud;
+	I_Assert(handle != NULL);
+	(void)L;
+	if (!sz) return 0; // nothing to write? can't fail that! :D
+	return (fwrite(p, 1, sz, handle) != sz); // if fwrite != sz, we've failed.
+}
+
+// Compiled scripts are cached in srb2home/luacache, one file per script.
+// Each file is a luacacheheader_t followed by lua_dump output. The name
+// of the file is the hash in the header, so a script is only looked up
+// under its current contents.
+#define LUACACHE_DIR "luacache"
+#define LUACACHE_MAGIC "SRB2LUAC"
+#define LUACACHE_MAXSIZE (128*1024*1024) // least recently used chunks are deleted past this
+
+typedef struct
+{
+	char magic[8];
+	char version[64]; // engine version and revision the chunk was built by
+	UINT64 hash; // of the chunk name and the source
+	UINT32 size; // of the source
+	UINT32 compiletime; // microseconds it took to compile the source
+} luacacheheader_t;
+
+typedef struct
+{
+	const char *data;
+	size_t size;
+} luachunk_t;
+
+// must match lua_Reader
+static const char *chunkReader(lua_State *L, void *ud, size_t *sz)
+{
+	luachunk_t *chunk = ud;
+	(void)L;
+	if (!chunk->size)
+		return NULL;
+	*sz = chunk->size;
+	chunk->size = 0;
+	return chunk->data;
+}
+
+static void LUA_CacheHeader(luacacheheader_t *header, const char *chunkname, MYFILE *f)
+{
+	UINT64 hash = UINT64_C(0xcbf29ce484222325); // 64-bit FNV-1a
+	const UINT8 *p;
+	size_t i;
+
+	for (p = (const UINT8 *)chunkname; *p; p++)
+		hash = (hash ^ *p) * UINT64_C(0x100000001b3);
+	for (i = 0, p = (const UINT8 *)f->data; i < f->size; i++)
+		hash = (hash ^ p[i]) * UINT64_C(0x100000001b3);
+
+	memset(header, 0, sizeof (*header));
+	memcpy(header->magic, LUACACHE_MAGIC, sizeof (header->magic));
+	snprintf(header->version, sizeof (header->version), "%s %s", VERSIONSTRING, comprevision);
+	header->hash = hash;
+	header->size = (UINT32)f->size;
+}
+
+static const char *LUA_CachePath(const luacacheheader_t *header)
+{
+	return va("%s" PATHSEP LUACACHE_DIR PATHSEP "%08x%08x.luc", srb2home,
+		(UINT32)(header->hash >> 32), (UINT32)header->hash);
+}
+
+/** Loads a script's compiled chunk from the bytecode cache.
+  *
+  * \param header The header the cached file must match.
+  * \param chunkname Name the chunk was compiled with.
+  * \param compiletime Set to the time the chunk once took to compile.
+  * \return true with the function on the stack, or false with the stack
+  *         unchanged if there is no valid cached chunk.
+  */
+static boolean LUA_LoadCachedChunk(const luacacheheader_t *header, const char *chunkname, UINT32 *compiletime)
+{
+	luacacheheader_t cached;
+	luachunk_t chunk;
+	FILE *handle;
+	char *data;
+	long length;
+	int status;
+
+	handle = fopen(LUA_CachePath(header), "rb");
+	if (!handle)
+		return false;
+
+	if (fread(&cached, sizeof (cached), 1, handle) != 1
+	|| memcmp(cached.magic, header->magic, sizeof (cached.magic))
+	|| memcmp(cached.version, header->version, sizeof (cached.version))
+	|| cached.hash != header->hash || cached.size != header->size
+	|| fseek(handle, 0, SEEK_END) || (length = ftell(handle) - (long)sizeof (cached)) <= 0
+	|| fseek(handle, sizeof (cached), SEEK_SET))
+	{
+		fclose(handle);
+		return false;
+	}
+
+	data = Z_Malloc(length, PU_STATIC, NULL);
+	if (fread(data, 1, length, handle) != (size_t)length)
+	{
+		fclose(handle);
+		Z_Free(data);
+		return false;
+	}
+	fclose(handle);
+
+	chunk.data = data;
+	chunk.size = length;
+	status = lua_loadtrusted(gL, chunkReader, &chunk, chunkname);
+	Z_Free(data);
+
+	if (status)
+	{
+		// Truncated or otherwise bad; recompile and overwrite it.
+		CONS_Debug(DBG_LUA, "Bad bytecode cache for %s: %s\n", chunkname + 1, lua_tostring(gL, -1));
+		lua_pop(gL, 1);
+		return false;
+	}
+
+	touchcachefile(LUA_CachePath(header));
+	*compiletime = cached.compiletime;
+	return true;
+}
+
+// Writes the compiled function on top of the stack to the bytecode cache.
+// The cache directory is pruned down to LUACACHE_MAXSIZE on the first
+// write of a session, and again every quarter of that written since.
+static void LUA_WriteCachedChunk(luacacheheader_t *header)
+{
+	static boolean madedir = false;
+	static size_t sinceprune = LUACACHE_MAXSIZE;
+	char path[256+32];
+	char temppath[sizeof (path) + 4];
+	FILE *handle;
+	boolean ok;
+
+	if (!madedir)
+	{
+		I_mkdir(va("%s" PATHSEP LUACACHE_DIR, srb2home), 0755);
+		madedir = true;
+	}
+
+	if (sinceprune >= LUACACHE_MAXSIZE / 4)
+	{
+		prunecachedirectory(va("%s" PATHSEP LUACACHE_DIR, srb2home), ".luc", LUACACHE_MAXSIZE);
+		sinceprune = 0;
+	}
+
+	strlcpy(path, LUA_CachePath(header), sizeof (path));
+	snprintf(temppath, sizeof (temppath), "%s.tmp", path);
+
+	// Written under a temporary name first, so that a crash or a second
+	// instance never leaves a half-written chunk under the real one.
+	handle = fopen(temppath, "wb");
+	if (!handle)
+		return;
+	ok = (fwrite(header, sizeof (*header), 1, handle) == 1 && !lua_dump(gL, dumpWriter, handle));
+	if (ok)
+		sinceprune += (size_t)ftell(handle);
+	ok = (fclose(handle) == 0 && ok);
+
+	remove(path);
+	if (!ok || rename(temppath, path))
+		remove(temppath);
+}
+
+/** Compiles a script like luaL_loadbuffer, going through the bytecode
+  * cache unless -noluacache was given.
+  *
+  * \param f The script source.
+  * \param chunkname Name to compile the chunk with.
+  * \return 0 with the function on the stack, or a Lua error code with
+  *         the error message on the stack.
+  */
+static int LUA_LoadChunk(MYFILE *f, const char *chunkname)
+{
+	static INT32 usecache = -1;
+	luacacheheader_t header;
+	precise_t start;
+	UINT32 compiletime;
+	int status;
+
+	if (usecache == -1)
+		usecache = !M_CheckParm("-noluacache");
+
+	// Scripts that already are bytecode have nothing to gain.
+	if (!usecache || (f->size && f->data[0] == LUA_SIGNATURE[0]))
+		return luaL_loadbuffer(gL, f->data, f->size, chunkname);
+
+	LUA_CacheHeader(&header, chunkname, f);
+
+	start = I_GetPreciseTime();
+	if (LUA_LoadCachedChunk(&header, chunkname, &compiletime))
+	{
+		UINT32 loadtime = (UINT32)((I_GetPreciseTime() - start) * 1000000 / I_GetPrecisePrecision());
+		UINT32 saved = (compiletime > loadtime) ? compiletime - loadtime : 0;
+		CONS_Debug(DBG_LUA, "Used cached bytecode, %u.%03u ms of compiling saved\n", saved / 1000, saved % 1000);
+		return 0;
+	}
+
+	status = luaL_loadbuffer(gL, f->data, f->size, chunkname);
+	if (status == 0)
+	{
+		header.compiletime = (UINT32)((I_GetPreciseTime() - start) * 1000000 / I_GetPrecisePrecision());
+		LUA_WriteCachedChunk(&header);
+	}
+	return status;
+}
+
 // Load a script from a MYFILE
 static inline void LUA_LoadFile(MYFILE *f, char *name, boolean noresults)
 {
 	int errorhandlerindex;
+	char *chunkname;
 
 	if (!name)
 		name = wadfiles[f->wad]->filename;
@@ -618,12 +1044,13 @@ static inline void LUA_LoadFile(MYFILE *f, char *name, boolean noresults)
 
 	lua_pushcfunction(gL, LUA_GetErrorMessage);
 	errorhandlerindex = lua_gettop(gL);
-	if (luaL_loadbuffer(gL, f->data, f->size, va("@%s",name)) || lua_pcall(gL, 0, noresults ? 0 : LUA_MULTRET, lua_gettop(gL) - 1)) {
+	chunkname = Z_StrDup(va("@%s",name)); // va is reused by the bytecode cache
+	if (LUA_LoadChunk(f, chunkname) || lua_pcall(gL, 0, noresults ? 0 : LUA_MULTRET, lua_gettop(gL) - 1)) {
 		CONS_Alert(CONS_WARNING,"%s\n",lua_tostring(gL,-1));
 		lua_pop(gL,1);
 	}
-	lua_gc(gL, LUA_GCCOLLECT, 0);
 	lua_remove(gL, errorhandlerindex);
+	Z_Free(chunkname);
 
 	lua_lumploading--; // turn off again
 }
@@ -663,16 +1090,6 @@ void LUA_LoadLump(UINT16 wad, UINT16 lump, boolean noresults)
 }
 
 #ifdef LUA_ALLOW_BYTECODE
-// must match lua_Writer
-static int dumpWriter(lua_State *L, const void *p, size_t sz, void *ud)
-{
-	FILE *handle = (FILE*)ud;
-	I_Assert(handle != NULL);
-	(void)L;
-	if (!sz) return 0; // nothing to write? can't fail that! :D
-	return (fwrite(p, 1, sz, handle) != sz); // if fwrite != sz, we've failed.
-}
-
 // Compile a script by name and dump it back to disk.
 void LUA_DumpFile(const char *filename)
 {
@@ -1044,6 +1461,8 @@ static UINT8 GetUserdataArchType(int index)
 
 static UINT8 ArchiveValue(int TABLESINDEX, int myindex)
 {
+	P_SaveReserve(SAVE_RECORDSPACE);
+
 	if (myindex < 0)
 		myindex = lua_gettop(gL)+1+myindex;
 	switch (lua_type(gL, myindex))
@@ -1093,6 +1512,7 @@ static UINT8 ArchiveValue(int TABLESINDEX, int myindex)
 		// fixing the awful crashes previously encountered for reading strings longer than 1024
 		// (yes I know that's kind of a stupid thing to care about, but it'd be evil to trim or ignore them?)
 		// -- Monster Iestyn 05/08/18
+		P_SaveReserve(SAVE_RECORDSPACE + len);
 		if (len < 255)
 		{
 			WRITEUINT8(save_p, ARCH_SMALLSTRING);
@@ -1361,6 +1781,8 @@ static void ArchiveExtVars(void *pointer, const char *ptype)
 	int TABLESINDEX;
 	UINT16 i;
 
+	P_SaveReserve(SAVE_RECORDSPACE);
+
 	if (!gL) {
 		if (fastcmp(ptype,"player")) // players must always be included, even if no vars
 			WRITEUINT16(save_p, 0);
@@ -1403,6 +1825,7 @@ static void ArchiveExtVars(void *pointer, const char *ptype)
 	while (lua_next(gL, -2))
 	{
 		I_Assert(lua_type(gL, -2) == LUA_TSTRING);
+		P_SaveReserve(SAVE_RECORDSPACE + lua_objlen(gL, -2));
 		WRITESTRING(save_p, lua_tostring(gL, -2));
 		if (ArchiveValue(TABLESINDEX, -1) == 2)
 			CONS_Alert(CONS_ERROR, "Type of value for %s entry '%s' (%s) could not be archived!\n", ptype, lua_tostring(gL, -2), luaL_typename(gL, -1));
@@ -1435,6 +1858,8 @@ static void ArchiveTables(void)
 	n = (UINT16)lua_objlen(gL, TABLESINDEX);
 	for (i = 1; i <= n; i++)
 	{
+		P_SaveReserve(SAVE_RECORDSPACE);
+
 		lua_rawgeti(gL, TABLESINDEX, i);
 		lua_pushnil(gL);
 		while (lua_next(gL, -2))
@@ -1686,12 +2111,84 @@ static void UnArchiveTables(void)
 	}
 }
 
-void LUA_Step(void)
+#define LUA_GCSTEPKB 4 // work done by a single incremental step, in KB
+#define LUA_GCMAXDEBTSTEPS 64 // most steps taken to pay debt outside of the budget
+#define LUA_GCPAUSE 2 // heap growth, relative to the end of a cycle, that starts the next one
+
+/** Runs the incremental garbage collector for up to a time budget.
+  * At least enough steps are taken to keep up with what Lua allocated since
+  * the previous call. The rest of the budget is only spent while the heap
+  * is overdue for collection: until a cycle ends, after which it waits for
+  * the heap to grow LUA_GCPAUSE times over. Debt left over after
+  * LUA_GCMAXDEBTSTEPS steps carries over to the next call instead of
+  * stalling this frame.
+  *
+  * \param budget Idle time that may be spent collecting, in precise_t units.
+  *               Zero only pays off the allocation debt.
+  */
+void LUA_Step(precise_t budget)
 {
+	precise_t start, now, steptime;
+	INT32 debt;
+	INT32 steps = 0;
+	precise_t maxpause = 0;
+	boolean overdue;
+
 	if (!gL)
 		return;
 	lua_settop(gL, 0);
-	lua_gc(gL, LUA_GCSTEP, 1);
+
+	debt = (INT32)(lua_gcdebt >> 10);
+	ps_lua_gcalloc.value.i = debt;
+	lua_gcdebt = 0;
+
+	ps_lua_memory.value.i = lua_gc(gL, LUA_GCCOUNT, 0);
+	if (lua_gcidle && ps_lua_memory.value.i >= lua_gcbase * LUA_GCPAUSE)
+		lua_gcidle = false;
+	overdue = !lua_gcidle;
+
+	if (debt <= 0 && !overdue)
+	{
+		ps_lua_gctime.value.p = 0;
+		ps_lua_gcpause.value.p = 0;
+		ps_lua_gcsteps.value.i = 0;
+		LUA_HoldCollector();
+		return;
+	}
+
+	PS_TRACE_BEGIN("LUA_Step");
+	start = now = I_GetPreciseTime();
+	do
+	{
+		int cycledone = lua_gc(gL, LUA_GCSTEP, LUA_GCSTEPKB);
+		precise_t stepstart = now;
+
+		now = I_GetPreciseTime();
+		steptime = now - stepstart;
+		if (steptime > maxpause)
+			maxpause = steptime;
+		steps++;
+		debt -= LUA_GCSTEPKB;
+
+		if (cycledone)
+		{
+			debt = 0; // a finished cycle has swept everything it owed
+			lua_gcidle = true;
+			lua_gcbase = lua_gc(gL, LUA_GCCOUNT, 0);
+			break;
+		}
+	} while ((debt > 0 && steps < LUA_GCMAXDEBTSTEPS) || (overdue && now - start + maxpause < budget));
+
+	if (debt > 0)
+		lua_gcdebt += (size_t)debt << 10;
+
+	LUA_HoldCollector();
+
+	ps_lua_gctime.value.p = now - start;
+	ps_lua_gcpause.value.p = maxpause;
+	ps_lua_gcsteps.value.i = steps;
+	ps_lua_memory.value.i = lua_gc(gL, LUA_GCCOUNT, 0);
+	PS_TRACE_END("LUA_Step");
 }
 
 void LUA_Archive(void)
@@ -1006,6 +1006,7 @@ static void OP_CycleThings(INT32 amt)
 	}
 
 	// HACK, minus has SPR_NULL sprite
+	P_JournalInfo(INFOTABLE_STATES, S_OBJPLACE_DUMMY);
 	if (states[mobjinfo[op_currentthing].spawnstate].sprite == SPR_NULL)
 	{
 		states[S_OBJPLACE_DUMMY].sprite = states[mobjinfo[op_currentthing].seestate].sprite;
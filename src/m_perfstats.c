@@ -18,6 +18,7 @@
 #include "z_zone.h"
 #include "p_local.h"
 #include "r_fps.h"
+#include "doomstat.h"
 
 #ifdef HWRENDER
 #include "hardware/hw_main.h"
@@ -68,6 +69,12 @@ ps_metric_t ps_checkposition_calls = {0};
 ps_metric_t ps_lua_thinkframe_time = {0};
 ps_metric_t ps_lua_mobjhooks = {0};
 
+ps_metric_t ps_lua_gctime = {0};
+ps_metric_t ps_lua_gcpause = {0};
+ps_metric_t ps_lua_gcsteps = {0};
+ps_metric_t ps_lua_gcalloc = {0};
+ps_metric_t ps_lua_memory = {0};
+
 ps_metric_t ps_otherlogictime = {0};
 
 // Columns for perfstats pages.
@@ -103,6 +110,7 @@ perfstatrow_t rendertime_rows[] = {
 	{" portals", " Portals+Skybox:", &ps_sw_portaltime, PS_TIME|PS_LEVEL|PS_SW},
 	{" planes ", " R_DrawPlanes:  ", &ps_sw_planetime, PS_TIME|PS_LEVEL|PS_SW},
 	{" masked ", " R_DrawMasked:  ", &ps_sw_maskedtime, PS_TIME|PS_LEVEL|PS_SW},
+	{"  sprsrt", "  Sprite sort:  ", &ps_sw_spritesorttime, PS_TIME|PS_LEVEL|PS_SW},
 	{" other  ", " Other:         ", &ps_otherrendertime, PS_TIME|PS_LEVEL|PS_SW},
 
 	{"ui     ", "UI render:     ", &ps_uitime, PS_TIME},
@@ -115,11 +123,28 @@ perfstatrow_t gamelogicbrief_row[] = {
 	{0}
 };
 
+perfstatrow_t luagc_rows[] = {
+	{"luagc  ", "Lua GC:        ", &ps_lua_gctime, PS_TIME},
+	{" pause ", " Longest step: ", &ps_lua_gcpause, PS_TIME},
+	{" steps ", " Steps:        ", &ps_lua_gcsteps, 0},
+	{" allockb", " Allocated KB: ", &ps_lua_gcalloc, 0},
+	{" heapkb ", " Heap KB:      ", &ps_lua_memory, 0},
+	{0}
+};
+
 perfstatrow_t commoncounter_rows[] = {
 	{"bspcall", "BSP calls:   ", &ps_numbspcalls, 0},
 	{"sprites", "Sprites:     ", &ps_numsprites, 0},
 	{"drwnode", "Drawnodes:   ", &ps_numdrawnodes, 0},
 	{"plyobjs", "Polyobjects: ", &ps_numpolyobjects, 0},
+	{"sprocld", "Spr occluded:", &ps_spritesoccluded, PS_SW},
+	{"sprclpd", "Spr clipped: ", &ps_spritesclipped, PS_SW},
+	{"rothits", "Rotspr hits: ", &ps_rotsprite_hits, 0},
+	{"rotmiss", "Rotspr miss: ", &ps_rotsprite_misses, 0},
+	{"rotkb  ", "Rotspr KB:   ", &ps_rotsprite_memory, 0},
+	{"visplns", "Visplanes:   ", &ps_numvisplanes, PS_SW},
+	{"vpmerge", "Plane merges:", &ps_visplanemerges, PS_SW},
+	{"vpchain", "Plane chain: ", &ps_visplanechain, PS_SW},
 	{0}
 };
 
@@ -477,6 +502,7 @@ static void PS_UpdateFrameStats(void)
 	if (cv_ps_samplesize.value > 1)
 	{
 		PS_UpdateRowHistories(rendertime_rows, true);
+		PS_UpdateRowHistories(luagc_rows, true);
 		if (PS_IsLevelActive())
 			PS_UpdateRowHistories(commoncounter_rows, true);
 
@@ -650,7 +676,9 @@ static void PS_DrawRenderStats(void)
 
 	y = PS_DrawPerfRows(20, 10, V_YELLOWMAP, rendertime_rows);
 
-	PS_DrawPerfRows(20, y + half_row, V_GRAYMAP, gamelogicbrief_row);
+	y = PS_DrawPerfRows(20, y + half_row, V_GRAYMAP, gamelogicbrief_row);
+
+	PS_DrawPerfRows(20, y + half_row, V_GREENMAP, luagc_rows);
 
 	if (PS_IsLevelActive())
 	{
@@ -840,3 +868,99 @@ void PS_SampleSize_OnChange(void)
 	if (cv_ps_samplesize.value > 1)
 		PS_ClearHistory();
 }
+
+// Trace scopes are kept in a ring buffer of the last PS_TRACESIZE
+// events. Only the main thread records and dumps them, so the buffer
+// needs no locking; the oldest events are simply overwritten.
+#define PS_TRACESIZE 65536 // must be a power of two
+
+typedef struct
+{
+	const char *name;
+	precise_t time;
+	tic_t tic;
+	boolean begin;
+} ps_traceevent_t;
+
+boolean ps_tracing = false;
+
+static ps_traceevent_t *ps_trace = NULL;
+static UINT32 ps_trace_head = 0; // events recorded since the buffer was allocated
+
+void PS_TraceEvent(const char *name, boolean begin)
+{
+	ps_traceevent_t *event = &ps_trace[ps_trace_head++ & (PS_TRACESIZE - 1)];
+	event->name = name;
+	event->time = I_GetPreciseTime();
+	event->tic = gametic;
+	event->begin = begin;
+}
+
+/** Writes the recorded trace scopes in Chrome's trace event format.
+  *
+  * \param path File to write to.
+  * \param first First tic to include.
+  * \param last Last tic to include.
+  * \return True if the file was written.
+  */
+boolean PS_DumpTrace(const char *path, tic_t first, tic_t last)
+{
+	UINT32 count = min(ps_trace_head, PS_TRACESIZE);
+	UINT32 i, written = 0;
+	INT32 depth = 0;
+	precise_t start = 0;
+	double usecs = I_GetPrecisePrecision() / 1000000.0;
+	FILE *f;
+
+	if (!ps_trace)
+	{
+		CONS_Printf(M_GetText("Nothing has been traced; turn on ps_trace first.\n"));
+		return true;
+	}
+
+	f = fopen(path, "w");
+	if (!f)
+		return false;
+
+	fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", f);
+	for (i = ps_trace_head - count; i != ps_trace_head; i++)
+	{
+		const ps_traceevent_t *event = &ps_trace[i & (PS_TRACESIZE - 1)];
+
+		if (event->tic < first || event->tic > last)
+			continue;
+
+		// The start of a scope may have been overwritten already.
+		if (event->begin)
+			depth++;
+		else if (depth > 0)
+			depth--;
+		else
+			continue;
+
+		if (!written)
+			start = event->time;
+
+		fprintf(f, "%s\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":1,\"args\":{\"tic\":%u}}",
+			written ? "," : "", event->name, event->begin ? 'B' : 'E',
+			(double)(event->time - start) / usecs, (UINT32)event->tic);
+		written++;
+	}
+	fputs("\n]}\n", f);
+
+	if (fclose(f))
+		return false;
+
+	CONS_Printf("Wrote %u trace events to %s\n", written, path);
+	return true;
+}
+
+void PS_Trace_OnChange(void)
+{
+	if (cv_ps_trace.value && !ps_trace)
+	{
+		ps_trace = Z_Malloc(PS_TRACESIZE * sizeof (*ps_trace), PU_STATIC, NULL);
+		ps_trace_head = 0;
+	}
+	ps_tracing = (cv_ps_trace.value && ps_trace);
+}
@@ -34,6 +34,13 @@ typedef struct
 #define PS_START_TIMING(metric) metric.value.p = I_GetPreciseTime()
 #define PS_STOP_TIMING(metric) metric.value.p = I_GetPreciseTime() - metric.value.p
 
+// Named trace scopes, recorded while ps_trace is on and dumped with
+// ps_tracedump. Scopes nest, and names must be string literals.
+#define PS_TRACE_BEGIN(name) do { if (ps_tracing) PS_TraceEvent(name, true); } while (0)
+#define PS_TRACE_END(name) do { if (ps_tracing) PS_TraceEvent(name, false); } while (0)
+
+extern boolean ps_tracing;
+
 extern ps_metric_t ps_tictime;
 
 extern ps_metric_t ps_playerthink_time;
@@ -46,6 +53,12 @@ extern ps_metric_t ps_checkposition_calls;
 extern ps_metric_t ps_lua_thinkframe_time;
 extern ps_metric_t ps_lua_mobjhooks;
 
+extern ps_metric_t ps_lua_gctime;
+extern ps_metric_t ps_lua_gcpause;
+extern ps_metric_t ps_lua_gcsteps;
+extern ps_metric_t ps_lua_gcalloc;
+extern ps_metric_t ps_lua_memory;
+
 extern ps_metric_t ps_otherlogictime;
 
 void PS_SetThinkFrameHookInfo(int index, precise_t time_taken, char* short_src);
@@ -57,4 +70,8 @@ void M_DrawPerfStats(void);
 void PS_PerfStats_OnChange(void);
 void PS_SampleSize_OnChange(void);
 
+void PS_TraceEvent(const char *name, boolean begin);
+boolean PS_DumpTrace(const char *path, tic_t first, tic_t last);
+void PS_Trace_OnChange(void);
+
 #endif
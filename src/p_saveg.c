@@ -39,6 +39,100 @@
 savedata_t savedata;
 UINT8 *save_p;
 
+// Growable buffer behind save_p
+static UINT8 *save_start, *save_end;
+static size_t save_chunksize;
+static size_t save_flushed;
+static void (*save_flush)(const UINT8 *data, size_t length);
+
+/** Starts writing a savegame with save_p.
+  *
+  * \param chunksize How much to write before handing the data to flush.
+  * \param flush     Receives the data in chunks of at least chunksize
+  *                  bytes. If NULL, the buffer grows to hold the whole
+  *                  savegame, to be picked up with P_SaveBufferFinish.
+  */
+void P_SaveBufferAlloc(size_t chunksize, void (*flush)(const UINT8 *data, size_t length))
+{
+	const size_t size = chunksize + SAVE_RECORDSPACE;
+
+	save_p = save_start = malloc(size);
+	if (!save_start)
+		I_Error("No more free memory for savegame");
+
+	save_end = save_start + size;
+	save_chunksize = chunksize;
+	save_flushed = 0;
+	save_flush = flush;
+}
+
+/** Makes sure length bytes can be written at save_p, flushing a full
+  * chunk or growing the buffer if needed. save_p may move, so this must
+  * not be called while holding pointers into the buffer.
+  *
+  * \param length Bytes about to be written.
+  */
+void P_SaveReserve(size_t length)
+{
+	size_t used;
+
+	// Something wrote past what it reserved; the heap is already damaged
+	if (save_p > save_end)
+		I_Error("Savegame buffer overrun");
+
+	used = save_p - save_start;
+
+	if (save_flush && used >= save_chunksize)
+	{
+		save_flush(save_start, used);
+		save_flushed += used;
+		save_p = save_start;
+		used = 0;
+	}
+
+	if ((size_t)(save_end - save_p) < length)
+	{
+		const size_t size = (used + length) * 2;
+		UINT8 *newbuffer = realloc(save_start, size);
+
+		if (!newbuffer)
+			I_Error("No more free memory for savegame");
+
+		save_start = newbuffer;
+		save_end = save_start + size;
+		save_p = save_start + used;
+	}
+}
+
+/** Ends writing a savegame.
+  *
+  * \param length Set to the size of the whole savegame.
+  * \return The buffer holding the savegame, to be freed with free(),
+  *         or NULL if it was all handed to the flush function.
+  */
+UINT8 *P_SaveBufferFinish(size_t *length)
+{
+	const size_t used = save_p - save_start;
+	UINT8 *buffer = save_start;
+
+	if (save_p > save_end)
+		I_Error("Savegame buffer overrun");
+
+	*length = save_flushed + used;
+
+	if (save_flush)
+	{
+		if (used)
+			save_flush(save_start, used);
+		free(save_start);
+		buffer = NULL;
+	}
+
+	save_p = save_start = save_end = NULL;
+	save_flush = NULL;
+	return buffer;
+}
+
 // Block UINT32s to attempt to ensure that the correct data is
 // being sent and received
 #define ARCHIVEBLOCK_MISC     0x7FEEDEED
@@ -135,6 +229,8 @@ static void P_NetArchivePlayers(void)
 
 	for (i = 0; i < MAXPLAYERS; i++)
 	{
+		P_SaveReserve(SAVE_RECORDSPACE);
+
 		WRITESINT8(save_p, (SINT8)adminplayers[i]);
 
 		if (!playeringame[i])
@@ -674,6 +770,8 @@ static void P_NetArchiveColormaps(void)
 
 	for (exc = net_colormaps; i < num_net_colormaps; i++, exc = exc_next)
 	{
+		P_SaveReserve(SAVE_RECORDSPACE);
+
 		// We must save num_net_colormaps worth of data
 		// So fill non-existent entries with default.
 		if (!exc)
@@ -807,6 +905,7 @@ static void P_NetArchiveWaypoints(void)
 
 	for (i = 0; i < NUMWAYPOINTSEQUENCES; i++)
 	{
+		P_SaveReserve(SAVE_RECORDSPACE);
 		WRITEUINT16(save_p, numwaypoints[i]);
 		for (j = 0; j < numwaypoints[i]; j++)
 			WRITEUINT32(save_p, waypoints[i][j] ? waypoints[i][j]->mobjnum : 0);
@@ -1009,6 +1108,8 @@ static void ArchiveSectors(void)
 
 	for (i = 0; i < numsectors; i++, ss++, spawnss++)
 	{
+		P_SaveReserve(SAVE_RECORDSPACE);
+
 		diff = diff2 = diff3 = diff4 = 0;
 		if (ss->floorheight != spawnss->floorheight)
 			diff |= SD_FLOORHT;
@@ -1113,6 +1214,7 @@ static void ArchiveSectors(void)
 				WRITEANGLE(save_p, ss->ceilingangle);
 			if (diff2 & SD_TAG)
 			{
+				P_SaveReserve(SAVE_RECORDSPACE + ss->tags.count*sizeof(INT16));
 				WRITEUINT32(save_p, ss->tags.count);
 				for (j = 0; j < ss->tags.count; j++)
 					WRITEINT16(save_p, ss->tags.tags[j]);
@@ -1282,6 +1384,8 @@ static void ArchiveLines(void)
 
 	for (i = 0; i < numlines; i++, spawnli++, li++)
 	{
+		P_SaveReserve(SAVE_RECORDSPACE);
+
 		diff = diff2 = 0;
 
 		if (li->special != spawnli->special)
@@ -1382,6 +1486,7 @@ static void ArchiveLines(void)
 					}
 
 					len = strlen(li->stringargs[j]);
+					P_SaveReserve(SAVE_RECORDSPACE + len);
 					WRITEINT32(save_p, len);
 					for (k = 0; k < len; k++)
 						WRITECHAR(save_p, li->stringargs[j][k]);
@@ -2503,6 +2608,8 @@ static void P_NetArchiveThinkers(void)
 		// save off the current thinkers
 		for (th = thlist[i].next; th != &thlist[i]; th = th->next)
 		{
+			P_SaveReserve(SAVE_RECORDSPACE);
+
 			if (!(th->function.acp1 == (actionf_p1)P_RemoveThinkerDelayed
 			 || th->function.acp1 == (actionf_p1)P_NullPrecipThinker))
 				numsaved++;
@@ -3053,6 +3160,8 @@ static thinker_t* LoadMobjThinker(actionf_p1 thinker)
 		slope->normal.x = READFIXED(save_p);
 		slope->normal.y = READFIXED(save_p);
 		slope->normal.z = READFIXED(save_p);
+
+		P_SlopeChanged(slope);
 	}
 	if (diff2 & MD2_DRAWONLYFORPLAYER)
 		mobj->drawonlyforplayer = &players[READUINT8(save_p)];
@@ -4023,7 +4132,10 @@ static inline void P_ArchivePolyObjects(void)
 	WRITEINT32(save_p, numPolyObjects);
 
 	for (i = 0; i < numPolyObjects; ++i)
+	{
+		P_SaveReserve(SAVE_RECORDSPACE);
 		P_ArchivePolyObj(&PolyObjects[i]);
+	}
 }
 
 static inline void P_UnArchivePolyObjects(void)
@@ -4167,6 +4279,8 @@ static inline void P_NetArchiveSpecials(void)
 	i = iquetail;
 	while (iquehead != i)
 	{
+		P_SaveReserve(SAVE_RECORDSPACE);
+
 		for (z = 0; z < nummapthings; z++)
 		{
 			if (&mapthings[z] == itemrespawnque[i])
@@ -4297,6 +4411,8 @@ static void P_NetArchiveMisc(boolean resending)
 {
 	INT32 i;
 
+	P_SaveReserve(SAVE_RECORDSPACE);
+
 	WRITEUINT32(save_p, ARCHIVEBLOCK_MISC);
 
 	if (resending)
@@ -4493,6 +4609,8 @@ static inline void P_NetArchiveEmblems(void)
 	// TODO: Optimize this to only send information about emblems, unlocks, etc. which actually exist
 	//       There is no need to go all the way up to MAXEMBLEMS when wads are guaranteed to be the same.
 
+	P_SaveReserve(SAVE_RECORDSPACE);
+
 	WRITEUINT32(save_p, data->totalplaytime);
 
 	// TODO put another cipher on these things? meh, I don't care...
@@ -4538,6 +4656,7 @@ static inline void P_NetArchiveEmblems(void)
 	WRITEUINT32(save_p, data->timesBeatenUltimate);
 
 	// Main records
+	P_SaveReserve(SAVE_RECORDSPACE);
 	for (i = 0; i < NUMMAPS; i++)
 	{
 		if (data->mainrecords[i])
@@ -4557,6 +4676,8 @@ static inline void P_NetArchiveEmblems(void)
 	// NiGHTS records
 	for (i = 0; i < NUMMAPS; i++)
 	{
+		P_SaveReserve(SAVE_RECORDSPACE);
+
 		if (!data->nightsrecords[i] || !data->nightsrecords[i]->nummares)
 		{
 			WRITEUINT8(save_p, 0);
@@ -4574,6 +4695,7 @@ static inline void P_NetArchiveEmblems(void)
 	}
 
 	// Mid-map stuff
+	P_SaveReserve(SAVE_RECORDSPACE);
 	WRITEUINT32(save_p, unlocktriggers);
 
 	for (i = 0; i < MAXPLAYERS; i++)
@@ -4739,6 +4861,8 @@ static inline void P_ArchiveLuabanksAndConsistency(void)
 {
 	UINT8 i, banksinuse = NUM_LUABANKS;
 
+	P_SaveReserve(SAVE_RECORDSPACE);
+
 	while (banksinuse && !luabanks[banksinuse-1])
 		banksinuse--; // get the last used bank
 
@@ -4785,6 +4909,7 @@ static inline boolean P_UnArchiveLuabanksAndConsistency(void)
 
 void P_SaveGame(INT16 mapnum)
 {
+	P_SaveReserve(SAVE_RECORDSPACE);
 	P_ArchiveMisc(mapnum);
 	P_ArchivePlayer();
 	P_ArchiveLuabanksAndConsistency();
@@ -4796,7 +4921,9 @@ void P_SaveNetGame(boolean resending)
 	mobj_t *mobj;
 	INT32 i = 1; // don't start from 0, it'd be confused with a blank pointer otherwise
 
+	P_SaveReserve(CV_SavedVarsSize(false));
 	CV_SaveNetVars(&save_p);
+	P_SaveReserve(SAVE_RECORDSPACE);
 	P_NetArchiveMisc(resending);
 	P_NetArchiveEmblems();
 
@@ -44,4 +44,11 @@ typedef struct
 extern savedata_t savedata;
 extern UINT8 *save_p;
 
+// Enough room for any single fixed-size record in a savegame
+#define SAVE_RECORDSPACE (64*1024)
+
+void P_SaveBufferAlloc(size_t chunksize, void (*flush)(const UINT8 *data, size_t length));
+void P_SaveReserve(size_t length);
+UINT8 *P_SaveBufferFinish(size_t *length);
+
 #endif
@@ -27,6 +27,12 @@
 pslope_t *slopelist = NULL;
 UINT16 slopecount = 0;
 
+// Invalidate heights cached by P_GetSlopeZAt
+void P_SlopeChanged(pslope_t *slope)
+{
+	slope->generation++;
+}
+
 // Calculate line normal
 void P_CalculateSlopeNormal(pslope_t *slope) {
 	slope->normal.z = FINECOSINE(slope->zangle>>ANGLETOFINESHIFT);
@@ -34,10 +40,22 @@ void P_CalculateSlopeNormal(pslope_t *slope) {
 	slope->normal.y = FixedMul(FINESINE(slope->zangle>>ANGLETOFINESHIFT), slope->d.y);
 }
 
+// Bump the slope's generation only if the reconfiguration moved it,
+// so dynamic slopes that sit still keep their cached heights
+static void SlopeChangedFrom(pslope_t *slope, const vector3_t *oldo, const vector3_t *oldnormal, fixed_t oldzdelta)
+{
+	if (slope->o.x != oldo->x || slope->o.y != oldo->y || slope->o.z != oldo->z
+	|| slope->normal.x != oldnormal->x || slope->normal.y != oldnormal->y || slope->normal.z != oldnormal->z
+	|| slope->zdelta != oldzdelta)
+		P_SlopeChanged(slope);
+}
+
 /// Setup slope via 3 vertexes.
 static void ReconfigureViaVertexes (pslope_t *slope, const vector3_t v1, const vector3_t v2, const vector3_t v3)
 {
 	vector3_t vec1, vec2;
+	vector3_t oldo = slope->o, oldnormal = slope->normal;
+	fixed_t oldzdelta = slope->zdelta;
 
 	// Set origin.
 	FV3_Copy(&slope->o, &v1);
@@ -89,6 +107,8 @@ static void ReconfigureViaVertexes (pslope_t *slope, const vector3_t v1, const v
 		slope->xydirection = R_PointToAngle2(0, 0, slope->d.x, slope->d.y)+ANGLE_180;
 		slope->zangle = InvAngle(R_PointToAngle2(0, 0, FRACUNIT, slope->zdelta));
 	}
+
+	SlopeChangedFrom(slope, &oldo, &oldnormal, oldzdelta);
 }
 
 /// Setup slope via constants.
@@ -97,6 +117,8 @@ static void ReconfigureViaConstants (pslope_t *slope, const fixed_t a, const fix
 	fixed_t m;
 	fixed_t o = 0;
 	vector3_t *normal = &slope->normal;
+	vector3_t oldo = slope->o, oldnormal = slope->normal;
+	fixed_t oldzdelta = slope->zdelta;
 
 	if (c)
 		o = abs(c) <= FRACUNIT ? -FixedMul(d, FixedDiv(FRACUNIT, c)) : -FixedDiv(d, c);
@@ -123,6 +145,8 @@ static void ReconfigureViaConstants (pslope_t *slope, const fixed_t a, const fix
 	// Get angles
 	slope->xydirection = R_PointToAngle2(0, 0, slope->d.x, slope->d.y)+ANGLE_180;
 	slope->zangle = InvAngle(R_PointToAngle2(0, 0, FRACUNIT, slope->zdelta));
+
+	SlopeChangedFrom(slope, &oldo, &oldnormal, oldzdelta);
 }
 
 /// Recalculate dynamic slopes.
@@ -132,6 +156,7 @@ void T_DynamicSlopeLine (dynlineplanethink_t* th)
 	line_t* srcline = th->sourceline;
 
 	fixed_t zdelta;
+	fixed_t oldz = slope->o.z;
 
 	switch(th->type) {
 	case DP_FRONTFLOOR:
@@ -162,7 +187,10 @@ void T_DynamicSlopeLine (dynlineplanethink_t* th)
 		slope->zdelta = FixedDiv(zdelta, th->extent);
 		slope->zangle = R_PointToAngle2(0, 0, th->extent, -zdelta);
 		P_CalculateSlopeNormal(slope);
+		P_SlopeChanged(slope);
 	}
+	else if (slope->o.z != oldz)
+		P_SlopeChanged(slope);
 }
 
 /// Mapthing-defined
@@ -243,6 +271,7 @@ static pslope_t *MakeViaVectors(const vector3_t *o, const vector2_t *d,
 	FV2_Copy(&ret->d, d);
 
 	ret->zdelta = zdelta;
+	P_SlopeChanged(ret);
 
 	ret->flags = flags;
 
@@ -754,16 +783,30 @@ void P_InitSlopes(void)
 //
 
 // Returns the height of the sloped plane at (x, y) as a fixed_t
-fixed_t P_GetSlopeZAt(const pslope_t *slope, fixed_t x, fixed_t y)
+// Collision code asks for the same slope at the same point several times
+// per tic, so recent results are kept until the slope changes. The formula
+// itself is left as is, since any rearranging would change the rounding.
+fixed_t P_GetSlopeZAt(pslope_t *slope, fixed_t x, fixed_t y)
 {
-	fixed_t dist = FixedMul(x - slope->o.x, slope->d.x) +
-	               FixedMul(y - slope->o.y, slope->d.y);
+	slopecache_t *c = &slope->cache[((UINT32)(x ^ y) >> FRACBITS) & (SLOPECACHESIZE - 1)];
+	fixed_t dist;
+
+	if (c->generation == slope->generation + 1 && c->x == x && c->y == y)
+		return c->z;
+
+	dist = FixedMul(x - slope->o.x, slope->d.x) +
+	       FixedMul(y - slope->o.y, slope->d.y);
+
+	c->x = x;
+	c->y = y;
+	c->z = slope->o.z + FixedMul(dist, slope->zdelta);
+	c->generation = slope->generation + 1;
 
-	return slope->o.z + FixedMul(dist, slope->zdelta);
+	return c->z;
 }
 
 // Like P_GetSlopeZAt but falls back to z if slope is NULL
-fixed_t P_GetZAt(const pslope_t *slope, fixed_t x, fixed_t y, fixed_t z)
+fixed_t P_GetZAt(pslope_t *slope, fixed_t x, fixed_t y, fixed_t z)
 {
 	return slope ? P_GetSlopeZAt(slope, x, y) : z;
 }
@@ -51,6 +51,11 @@ typedef enum
 void P_LinkSlopeThinkers (void);
 
 void P_CalculateSlopeNormal(pslope_t *slope);
+
+// Must be called after changing a slope's origin, direction or zdelta,
+// so P_GetSlopeZAt doesn't return heights cached from before
+void P_SlopeChanged(pslope_t *slope);
+
 void P_InitSlopes(void);
 void P_SpawnSlopes(const boolean fromsave);
 
@@ -64,10 +69,10 @@ void P_CopySectorSlope(line_t *line);
 pslope_t *P_SlopeById(UINT16 id);
 
 // Returns the height of the sloped plane at (x, y) as a fixed_t
-fixed_t P_GetSlopeZAt(const pslope_t *slope, fixed_t x, fixed_t y);
+fixed_t P_GetSlopeZAt(pslope_t *slope, fixed_t x, fixed_t y);
 
 // Like P_GetSlopeZAt but falls back to z if slope is NULL
-fixed_t P_GetZAt(const pslope_t *slope, fixed_t x, fixed_t y, fixed_t z);
+fixed_t P_GetZAt(pslope_t *slope, fixed_t x, fixed_t y, fixed_t z);
 
 // Returns the height of the sector at (x, y)
 fixed_t P_GetSectorFloorZAt  (const sector_t *sector, fixed_t x, fixed_t y);
@@ -118,6 +118,7 @@ static void P_AddFloatThinker(sector_t *sec, UINT16 tag, line_t *sourceline);
 //static void P_AddBridgeThinker(line_t *sourceline, sector_t *sec);
 static void P_AddFakeFloorsByLine(size_t line, INT32 alpha, UINT8 blendmode, ffloortype_e ffloorflags, thinkerlist_t *secthinkers);
 static void P_ProcessLineSpecial(line_t *line, mobj_t *mo, sector_t *callsec);
+static void P_InitTriggerIndex(void);
 static void Add_Friction(INT32 friction, INT32 movefactor, INT32 affectee, INT32 referrer);
 static void P_AddPlaneDisplaceThinker(INT32 type, fixed_t speed, INT32 control, INT32 affectee, UINT8 reverse);
 
@@ -1214,48 +1215,268 @@ static boolean PolyRotDisplace(line_t *line)
 }
 
 
-//
-// P_RunNightserizeExecutors
-//
-void P_RunNightserizeExecutors(mobj_t *actor)
+// =========================================================================
+//                        LINEDEF EXECUTOR INDEX
+// =========================================================================
+
+// Trigger linedefs that aren't found by tag, but are run by the game itself.
+typedef enum
+{
+	GT_NIGHTSERIZE, // 323
+	GT_DENIGHTSERIZE, // 325
+	GT_NIGHTSLAP, // 327
+	GT_CAPSULETOUCH, // 329
+	GT_LEVELLOAD, // 399
+
+	NUMGLOBALTRIGGERS
+} globaltrigger_t;
+
+static const INT16 globaltriggerspecials[NUMGLOBALTRIGGERS] = {323, 325, 327, 329, 399};
+
+// The executor linedefs a trigger linedef fires, in activation order.
+typedef struct
+{
+	size_t start; // first entry in triggerexeclines
+	size_t count;
+	boolean closed; // false if the walk around the control sector was aborted
+	boolean cached;
+} triggerexecs_t;
+
+static triggerexecs_t *triggerexecs; // one per linedef
+static size_t *triggerexeclines; // linedef numbers, stored contiguously
+static size_t triggerexeclines_count, triggerexeclines_max;
+
+static size_t *globaltriggerlines[NUMGLOBALTRIGGERS];
+static size_t globaltriggerlines_count[NUMGLOBALTRIGGERS], globaltriggerlines_max[NUMGLOBALTRIGGERS];
+
+static void P_AddTriggerExecLine(line_t *line)
+{
+	// Executor specials are never changed after the level is loaded,
+	// so anything else can be left out.
+	if (line->special < 400 || line->special >= 500)
+		return;
+
+	if (triggerexeclines_count == triggerexeclines_max)
+	{
+		triggerexeclines_max = triggerexeclines_max ? triggerexeclines_max * 2 : 256;
+		triggerexeclines = Z_Realloc(triggerexeclines, triggerexeclines_max * sizeof (*triggerexeclines), PU_LEVEL, NULL);
+	}
+
+	triggerexeclines[triggerexeclines_count++] = (size_t)(line - lines);
+}
+
+/** Walks around the control sector of a trigger linedef and records the
+  * linedef executors it activates, in the order it activates them.
+  *
+  * \param triggerline Trigger linedef to index.
+  * \return False if the control sector isn't closed and the walk was aborted.
+  */
+static boolean P_IndexLinedefExecutorsInSector(line_t *triggerline)
 {
+	sector_t *ctlsector = triggerline->frontsector;
+	size_t sectori = (size_t)(ctlsector - sectors);
+	size_t linecnt = ctlsector->linecount;
 	size_t i;
 
-	for (i = 0; i < numlines; i++)
+	if (!udmf && triggerline->flags & ML_WRAPMIDTEX) // disregard order for efficiency
 	{
-		if (lines[i].special == 323)
-			P_RunTriggerLinedef(&lines[i], actor, NULL);
+		for (i = 0; i < linecnt; i++)
+			P_AddTriggerExecLine(ctlsector->lines[i]);
 	}
+	else // walk around the sector in a defined order
+	{
+		boolean backwards = false;
+		size_t j, masterlineindex = (size_t)-1;
+
+		for (i = 0; i < linecnt; i++)
+			if (ctlsector->lines[i] == triggerline)
+			{
+				masterlineindex = i;
+				break;
+			}
+
+#ifdef PARANOIA
+		if (masterlineindex == (size_t)-1)
+		{
+			const size_t li = (size_t)(ctlsector->lines[i] - lines);
+			I_Error("Line %s isn't linked into its front sector", sizeu1(li));
+		}
+#endif
+
+		// i == masterlineindex
+		for (;;)
+		{
+			if (backwards) // v2 to v1
+			{
+				for (j = 0; j < linecnt; j++)
+				{
+					if (i == j)
+						continue;
+					if (ctlsector->lines[i]->v1 == ctlsector->lines[j]->v2)
+					{
+						i = j;
+						break;
+					}
+					if (ctlsector->lines[i]->v1 == ctlsector->lines[j]->v1)
+					{
+						i = j;
+						backwards = false;
+						break;
+					}
+				}
+				if (j == linecnt)
+				{
+					const size_t vertexei = (size_t)(ctlsector->lines[i]->v1 - vertexes);
+					CONS_Debug(DBG_GAMELOGIC, "Warning: Sector %s is not closed at vertex %s (%d, %d)\n",
+						sizeu1(sectori), sizeu2(vertexei), ctlsector->lines[i]->v1->x, ctlsector->lines[i]->v1->y);
+					return false; // abort
+				}
+			}
+			else // v1 to v2
+			{
+				for (j = 0; j < linecnt; j++)
+				{
+					if (i == j)
+						continue;
+					if (ctlsector->lines[i]->v2 == ctlsector->lines[j]->v1)
+					{
+						i = j;
+						break;
+					}
+					if (ctlsector->lines[i]->v2 == ctlsector->lines[j]->v2)
+					{
+						i = j;
+						backwards = true;
+						break;
+					}
+				}
+				if (j == linecnt)
+				{
+					const size_t vertexei = (size_t)(ctlsector->lines[i]->v1 - vertexes);
+					CONS_Debug(DBG_GAMELOGIC, "Warning: Sector %s is not closed at vertex %s (%d, %d)\n",
+						sizeu1(sectori), sizeu2(vertexei), ctlsector->lines[i]->v2->x, ctlsector->lines[i]->v2->y);
+					return false; // abort
+				}
+			}
+
+			if (i == masterlineindex)
+				break;
+
+			P_AddTriggerExecLine(ctlsector->lines[i]);
+		}
+	}
+
+	return true;
 }
 
-//
-// P_RunDeNightserizeExecutors
-//
-void P_RunDeNightserizeExecutors(mobj_t *actor)
+/** Finds the executor list of a trigger linedef, indexing it first if
+  * it wasn't a trigger when the level was loaded.
+  *
+  * \param triggerline Trigger linedef; must have a front sector.
+  * \return The trigger's entry in the executor index.
+  */
+static triggerexecs_t *P_GetTriggerExecs(line_t *triggerline)
+{
+	triggerexecs_t *te = &triggerexecs[triggerline - lines];
+
+	if (!te->cached)
+	{
+		te->start = triggerexeclines_count;
+		te->closed = P_IndexLinedefExecutorsInSector(triggerline);
+		te->count = triggerexeclines_count - te->start;
+		te->cached = true;
+	}
+
+	return te;
+}
+
+/** Builds the linedef executor index for the current level: for each trigger
+  * linedef, the contiguous list of executors it fires, and the lists of
+  * triggers the game runs directly (NiGHTS events, level load).
+  * The index only depends on level geometry and load-time specials, so it
+  * never has to be rebuilt during the level.
+  *
+  * \sa P_SpawnSpecials
+  */
+static void P_InitTriggerIndex(void)
 {
 	size_t i;
+	INT32 j;
+
+	triggerexecs = Z_Calloc(numlines * sizeof (*triggerexecs), PU_LEVEL, NULL);
+	triggerexeclines = NULL;
+	triggerexeclines_count = triggerexeclines_max = 0;
+
+	for (j = 0; j < NUMGLOBALTRIGGERS; j++)
+	{
+		globaltriggerlines[j] = NULL;
+		globaltriggerlines_count[j] = globaltriggerlines_max[j] = 0;
+	}
 
 	for (i = 0; i < numlines; i++)
 	{
-		if (lines[i].special == 325)
-			P_RunTriggerLinedef(&lines[i], actor, NULL);
+		if (lines[i].special < 300 || lines[i].special > 399 || !lines[i].frontsector)
+			continue;
+
+		P_GetTriggerExecs(&lines[i]);
+
+		for (j = 0; j < NUMGLOBALTRIGGERS; j++)
+		{
+			if (lines[i].special != globaltriggerspecials[j])
+				continue;
+
+			if (globaltriggerlines_count[j] == globaltriggerlines_max[j])
+			{
+				globaltriggerlines_max[j] = globaltriggerlines_max[j] ? globaltriggerlines_max[j] * 2 : 8;
+				globaltriggerlines[j] = Z_Realloc(globaltriggerlines[j], globaltriggerlines_max[j] * sizeof (*globaltriggerlines[j]), PU_LEVEL, NULL);
+			}
+
+			globaltriggerlines[j][globaltriggerlines_count[j]++] = i;
+			break;
+		}
 	}
 }
 
-//
-// P_RunNightsLapExecutors
-//
-void P_RunNightsLapExecutors(mobj_t *actor)
+/** Runs every trigger linedef of a type the game runs directly.
+  * Once-only triggers clear their special when run, so it's checked again.
+  */
+static void P_RunGlobalTriggers(globaltrigger_t type, mobj_t *actor)
 {
 	size_t i;
 
-	for (i = 0; i < numlines; i++)
+	for (i = 0; i < globaltriggerlines_count[type]; i++)
 	{
-		if (lines[i].special == 327)
-			P_RunTriggerLinedef(&lines[i], actor, NULL);
+		line_t *line = &lines[globaltriggerlines[type][i]];
+
+		if (line->special == globaltriggerspecials[type])
+			P_RunTriggerLinedef(line, actor, NULL);
 	}
 }
 
+//
+// P_RunNightserizeExecutors
+//
+void P_RunNightserizeExecutors(mobj_t *actor)
+{
+	P_RunGlobalTriggers(GT_NIGHTSERIZE, actor);
+}
+
+//
+// P_RunDeNightserizeExecutors
+//
+void P_RunDeNightserizeExecutors(mobj_t *actor)
+{
+	P_RunGlobalTriggers(GT_DENIGHTSERIZE, actor);
+}
+
+//
+// P_RunNightsLapExecutors
+//
+void P_RunNightsLapExecutors(mobj_t *actor)
+{
+	P_RunGlobalTriggers(GT_NIGHTSLAP, actor);
+}
+
 //
 // P_RunNightsCapsuleTouchExecutors
 //
@@ -1263,21 +1484,23 @@ void P_RunNightsCapsuleTouchExecutors(mobj_t *actor, boolean entering, boolean e
 {
 	size_t i;
 
-	for (i = 0; i < numlines; i++)
+	for (i = 0; i < globaltriggerlines_count[GT_CAPSULETOUCH]; i++)
 	{
-		if (lines[i].special != 329)
+		line_t *line = &lines[globaltriggerlines[GT_CAPSULETOUCH][i]];
+
+		if (line->special != 329)
 			continue;
 
-		if (!!(lines[i].args[7] & TMI_ENTER) != entering)
+		if (!!(line->args[7] & TMI_ENTER) != entering)
 			continue;
 
-		if (lines[i].args[6] == TMS_IFENOUGH && !enoughspheres)
+		if (line->args[6] == TMS_IFENOUGH && !enoughspheres)
 			continue;
 
-		if (lines[i].args[6] == TMS_IFNOTENOUGH && enoughspheres)
+		if (line->args[6] == TMS_IFNOTENOUGH && enoughspheres)
 			continue;
 
-		P_RunTriggerLinedef(&lines[i], actor, NULL);
+		P_RunTriggerLinedef(line, actor, NULL);
 	}
 }
 
@@ -1643,100 +1866,15 @@ static void P_ActivateLinedefExecutor(line_t *line, mobj_t *actor, sector_t *cal
 
 static boolean P_ActivateLinedefExecutorsInSector(line_t *triggerline, mobj_t *actor, sector_t *caller)
 {
-	sector_t *ctlsector = triggerline->frontsector;
-	size_t sectori = (size_t)(ctlsector - sectors);
-	size_t linecnt = ctlsector->linecount;
+	triggerexecs_t *te = P_GetTriggerExecs(triggerline);
 	size_t i;
 
-	if (!udmf && triggerline->flags & ML_WRAPMIDTEX) // disregard order for efficiency
-	{
-		for (i = 0; i < linecnt; i++)
-			P_ActivateLinedefExecutor(ctlsector->lines[i], actor, caller);
-	}
-	else // walk around the sector in a defined order
-	{
-		boolean backwards = false;
-		size_t j, masterlineindex = (size_t)-1;
-
-		for (i = 0; i < linecnt; i++)
-			if (ctlsector->lines[i] == triggerline)
-			{
-				masterlineindex = i;
-				break;
-			}
+	// Executors can run other triggers, which may grow the index;
+	// don't hold onto a pointer into it.
+	for (i = 0; i < te->count; i++)
+		P_ActivateLinedefExecutor(&lines[triggerexeclines[te->start + i]], actor, caller);
 
-#ifdef PARANOIA
-		if (masterlineindex == (size_t)-1)
-		{
-			const size_t li = (size_t)(ctlsector->lines[i] - lines);
-			I_Error("Line %s isn't linked into its front sector", sizeu1(li));
-		}
-#endif
-
-		// i == masterlineindex
-		for (;;)
-		{
-			if (backwards) // v2 to v1
-			{
-				for (j = 0; j < linecnt; j++)
-				{
-					if (i == j)
-						continue;
-					if (ctlsector->lines[i]->v1 == ctlsector->lines[j]->v2)
-					{
-						i = j;
-						break;
-					}
-					if (ctlsector->lines[i]->v1 == ctlsector->lines[j]->v1)
-					{
-						i = j;
-						backwards = false;
-						break;
-					}
-				}
-				if (j == linecnt)
-				{
-					const size_t vertexei = (size_t)(ctlsector->lines[i]->v1 - vertexes);
-					CONS_Debug(DBG_GAMELOGIC, "Warning: Sector %s is not closed at vertex %s (%d, %d)\n",
-						sizeu1(sectori), sizeu2(vertexei), ctlsector->lines[i]->v1->x, ctlsector->lines[i]->v1->y);
-					return false; // abort
-				}
-			}
-			else // v1 to v2
-			{
-				for (j = 0; j < linecnt; j++)
-				{
-					if (i == j)
-						continue;
-					if (ctlsector->lines[i]->v2 == ctlsector->lines[j]->v1)
-					{
-						i = j;
-						break;
-					}
-					if (ctlsector->lines[i]->v2 == ctlsector->lines[j]->v2)
-					{
-						i = j;
-						backwards = true;
-						break;
-					}
-				}
-				if (j == linecnt)
-				{
-					const size_t vertexei = (size_t)(ctlsector->lines[i]->v1 - vertexes);
-					CONS_Debug(DBG_GAMELOGIC, "Warning: Sector %s is not closed at vertex %s (%d, %d)\n",
-						sizeu1(sectori), sizeu2(vertexei), ctlsector->lines[i]->v2->x, ctlsector->lines[i]->v2->y);
-					return false; // abort
-				}
-			}
-
-			if (i == masterlineindex)
-				break;
-
-			P_ActivateLinedefExecutor(ctlsector->lines[i], actor, caller);
-		}
-	}
-
-	return true;
+	return te->closed;
 }
 
 /** Used by P_LinedefExecute to check a trigger linedef's conditions
@@ -6070,13 +6208,7 @@ static inline void P_AddLaserThinker(INT16 tag, line_t *line, boolean nobosses)
 //
 static void P_RunLevelLoadExecutors(void)
 {
-	size_t i;
-
-	for (i = 0; i < numlines; i++)
-	{
-		if (lines[i].special == 399)
-			P_RunTriggerLinedef(&lines[i], NULL, NULL);
-	}
+	P_RunGlobalTriggers(GT_LEVELLOAD, NULL);
 }
 
 /** Before things are loaded, initialises certain stuff in case they're needed
@@ -6255,6 +6387,7 @@ void P_SpawnSpecials(boolean fromnetsave)
 		}
 	}
 
+	P_InitTriggerIndex(); // Index linedef executors by trigger
 	P_SpawnScrollers(); // Add generalized scrollers
 	P_SpawnFriction();  // Friction model using linedefs
 	P_SpawnPushers();   // Pusher model using linedefs
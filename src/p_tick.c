@@ -416,9 +416,13 @@ mobj_t *P_SetTarget2(mobj_t **mop, mobj_t *targ
 //
 static inline void P_RunThinkers(void)
 {
+	static const char *const tracenames[NUM_THINKERLISTS] = {
+		"Polyobjects", "Main thinkers", "Mobjs", "Dynamic slopes", "Precipitation"
+	};
 	size_t i;
 	for (i = 0; i < NUM_THINKERLISTS; i++)
 	{
+		PS_TRACE_BEGIN(tracenames[i]);
 		PS_START_TIMING(ps_thlist_times[i]);
 		for (currentthinker = thlist[i].next; currentthinker != &thlist[i]; currentthinker = currentthinker->next)
 		{
@@ -428,6 +432,7 @@ static inline void P_RunThinkers(void)
 			currentthinker->function.acp1(currentthinker);
 		}
 		PS_STOP_TIMING(ps_thlist_times[i]);
+		PS_TRACE_END(tracenames[i]);
 	}
 
 }
@@ -756,13 +761,17 @@ void P_Ticker(boolean run)
 		ps_lua_mobjhooks.value.i = 0;
 		ps_checkposition_calls.value.i = 0;
 
+		PS_TRACE_BEGIN("PreThinkFrame");
 		LUA_HOOK(PreThinkFrame);
+		PS_TRACE_END("PreThinkFrame");
 
+		PS_TRACE_BEGIN("P_PlayerThink");
 		PS_START_TIMING(ps_playerthink_time);
 		for (i = 0; i < MAXPLAYERS; i++)
 			if (playeringame[i] && players[i].mo && !P_MobjWasRemoved(players[i].mo))
 				P_PlayerThink(&players[i]);
 		PS_STOP_TIMING(ps_playerthink_time);
+		PS_TRACE_END("P_PlayerThink");
 	}
 
 	// Keep track of how long they've been playing!
@@ -780,29 +789,43 @@ void P_Ticker(boolean run)
 
 	if (run)
 	{
+		PS_TRACE_BEGIN("P_RunThinkers");
 		PS_START_TIMING(ps_thinkertime);
 		P_RunThinkers();
 		PS_STOP_TIMING(ps_thinkertime);
+		PS_TRACE_END("P_RunThinkers");
 
 		// Run any "after all the other thinkers" stuff
+		PS_TRACE_BEGIN("P_PlayerAfterThink");
 		for (i = 0; i < MAXPLAYERS; i++)
 			if (playeringame[i] && players[i].mo && !P_MobjWasRemoved(players[i].mo))
 				P_PlayerAfterThink(&players[i]);
+		PS_TRACE_END("P_PlayerAfterThink");
 
+		PS_TRACE_BEGIN("ThinkFrame");
 		PS_START_TIMING(ps_lua_thinkframe_time);
 		LUA_HookThinkFrame();
 		PS_STOP_TIMING(ps_lua_thinkframe_time);
+		PS_TRACE_END("ThinkFrame");
 	}
 
 	// Run shield positioning
+	PS_TRACE_BEGIN("P_RunShields");
 	P_RunShields();
+	PS_TRACE_END("P_RunShields");
+	PS_TRACE_BEGIN("P_RunOverlays");
 	P_RunOverlays();
+	PS_TRACE_END("P_RunOverlays");
 
+	PS_TRACE_BEGIN("P_UpdateSpecials");
 	P_UpdateSpecials();
 	P_RespawnSpecials();
+	PS_TRACE_END("P_UpdateSpecials");
 
 	// Lightning, rain sounds, etc.
+	PS_TRACE_BEGIN("P_PrecipitationEffects");
 	P_PrecipitationEffects();
+	PS_TRACE_END("P_PrecipitationEffects");
 
 	if (run)
 		leveltime++;
@@ -863,7 +886,9 @@ void P_Ticker(boolean run)
 		if (modeattacking)
 			G_GhostTicker();
 
+		PS_TRACE_BEGIN("PostThinkFrame");
 		LUA_HOOK(PostThinkFrame);
+		PS_TRACE_END("PostThinkFrame");
 	}
 
 	if (run)
@@ -54,6 +54,20 @@ void R_ClearDrawSegs(void)
 static cliprange_t *newend;
 static cliprange_t solidsegs[MAXSEGS];
 
+// Scale of the solid wall covering each column in solidsegs, for sprite
+// occlusion. Portals are 0, since they don't hide anything.
+static fixed_t solidscale[MAXVIDWIDTH];
+
+static void R_StoreSolidWallRange(INT32 start, INT32 stop)
+{
+	INT32 x;
+
+	R_StoreWallRange(start, stop);
+
+	for (x = start; x <= stop; x++)
+		solidscale[x] = portalline ? 0 : frontscale[x];
+}
+
 //
 // R_ClipSolidWallSegment
 // Does handle solid walls,
@@ -75,7 +89,7 @@ static void R_ClipSolidWallSegment(INT32 first, INT32 last)
 		if (last < start->first - 1)
 		{
 			// Post is entirely visible (above start), so insert a new clippost.
-			R_StoreWallRange(first, last);
+			R_StoreSolidWallRange(first, last);
 			next = newend;
 			newend++;
 			// NO MORE CRASHING!
@@ -93,7 +107,7 @@ static void R_ClipSolidWallSegment(INT32 first, INT32 last)
 		}
 
 		// There is a fragment above *start.
-		R_StoreWallRange(first, start->first - 1);
+		R_StoreSolidWallRange(first, start->first - 1);
 		// Now adjust the clip size.
 		start->first = first;
 	}
@@ -106,7 +120,7 @@ static void R_ClipSolidWallSegment(INT32 first, INT32 last)
 	while (last >= (next+1)->first - 1)
 	{
 		// There is a fragment between two posts.
-		R_StoreWallRange(next->last + 1, (next+1)->first - 1);
+		R_StoreSolidWallRange(next->last + 1, (next+1)->first - 1);
 		next++;
 
 		if (last <= next->last)
@@ -119,7 +133,7 @@ static void R_ClipSolidWallSegment(INT32 first, INT32 last)
 	}
 
 	// There is a fragment after *next.
-	R_StoreWallRange(next->last + 1, last);
+	R_StoreSolidWallRange(next->last + 1, last);
 	// Adjust the clip size.
 	start->last = last;
 
@@ -184,6 +198,36 @@ static inline void R_ClipPassWallSegment(INT32 first, INT32 last)
 	R_StoreWallRange(start->last + 1, last);
 }
 
+//
+// R_IsRangeOccluded
+// Checks if columns x1 to x2 are behind a single run of solid walls that are
+//  all closer to the view than scale.
+//
+boolean R_IsRangeOccluded(INT32 x1, INT32 x2, fixed_t scale)
+{
+	cliprange_t *start = solidsegs;
+	INT32 x;
+
+	if (x1 < 0)
+		x1 = 0;
+	if (x2 >= viewwidth)
+		x2 = viewwidth - 1;
+	if (x1 > x2)
+		return false;
+
+	while (start->last < x1)
+		start++;
+
+	if (start->first > x1 || start->last < x2)
+		return false;
+
+	for (x = x1; x <= x2; x++)
+		if (solidscale[x] <= scale)
+			return false;
+
+	return true;
+}
+
 //
 // R_ClearClipSegs
 //
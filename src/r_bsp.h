@@ -37,6 +37,7 @@ extern INT32 doorclosed;
 // BSP?
 void R_ClearClipSegs(void);
 void R_PortalClearClipSegs(INT32 start, INT32 end);
+boolean R_IsRangeOccluded(INT32 x1, INT32 x2, fixed_t scale);
 void R_ClearDrawSegs(void);
 void R_RenderBSPNode(INT32 bspnum);
 
@@ -296,6 +296,15 @@ typedef enum {
 	SL_DYNAMIC = 1<<1, /// This plane slope will be assigned a thinker to make it dynamic.
 } slopeflags_t;
 
+#define SLOPECACHESIZE 4 // must be a power of two
+
+// A previous evaluation of a slope's height, see P_GetSlopeZAt
+typedef struct
+{
+	fixed_t x, y, z;
+	UINT32 generation; /// Slope generation + 1 when this entry was filled, 0 if empty.
+} slopecache_t;
+
 typedef struct pslope_s
 {
 	UINT16 id; // The number of the slope, mostly used for netgame syncing purposes
@@ -313,6 +322,9 @@ typedef struct pslope_s
 	angle_t xydirection;/// Precomputed angle of the normal's projection on the XY plane.
 
 	UINT8 flags; // Slope options
+
+	UINT32 generation; /// Incremented whenever o, d or zdelta change; see P_SlopeChanged.
+	slopecache_t cache[SLOPECACHESIZE]; /// Recent results of P_GetSlopeZAt.
 } pslope_t;
 
 typedef enum
@@ -787,6 +799,7 @@ typedef struct
 {
 	INT32 angles;
 	void **patches;
+	UINT32 *lastused; // When each of the patches was last fetched, for Patch_GetRotatedSprite's cache
 } rotsprite_t;
 #endif
 
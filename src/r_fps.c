@@ -19,6 +19,7 @@
 #include "i_video.h"
 #include "r_plane.h"
 #include "p_spec.h"
+#include "p_slopes.h" // P_SlopeChanged
 #include "r_state.h"
 #include "z_zone.h"
 #include "console.h" // con_startup_loadprogress
@@ -120,6 +121,19 @@ static vector3_t *R_LerpVector3(const vector3_t *from, const vector3_t *to, fixe
 	return out;
 }
 
+// Move an interpolated slope, invalidating its height cache only if it actually moved
+static void R_SetDynSlope(pslope_t *slope, const vector3_t *o, const vector2_t *d, fixed_t zdelta)
+{
+	if (slope->o.x == o->x && slope->o.y == o->y && slope->o.z == o->z
+	&& slope->d.x == d->x && slope->d.y == d->y && slope->zdelta == zdelta)
+		return;
+
+	FV3_Copy(&slope->o, o);
+	FV2_Copy(&slope->d, d);
+	slope->zdelta = zdelta;
+	P_SlopeChanged(slope);
+}
+
 // recalc necessary stuff for mouseaiming
 // slopes are already calculated for the full possible view (which is 4*viewheight).
 // 18/08/18: (No it's actually 16*viewheight, thanks Jimita for finding this out)
@@ -628,9 +642,13 @@ void R_ApplyLevelInterpolators(fixed_t frac)
 			interp->polyobj.polyobj->centerPt.y = R_LerpFixed(interp->polyobj.oldcy, interp->polyobj.bakcy, frac);
 			break;
 		case LVLINTERP_DynSlope:
-			R_LerpVector3(&interp->dynslope.oldo, &interp->dynslope.bako, frac, &interp->dynslope.slope->o);
-			R_LerpVector2(&interp->dynslope.oldd, &interp->dynslope.bakd, frac, &interp->dynslope.slope->d);
-			interp->dynslope.slope->zdelta = R_LerpFixed(interp->dynslope.oldzdelta, interp->dynslope.bakzdelta, frac);
+			{
+				vector3_t o;
+				vector2_t d;
+				R_LerpVector3(&interp->dynslope.oldo, &interp->dynslope.bako, frac, &o);
+				R_LerpVector2(&interp->dynslope.oldd, &interp->dynslope.bakd, frac, &d);
+				R_SetDynSlope(interp->dynslope.slope, &o, &d, R_LerpFixed(interp->dynslope.oldzdelta, interp->dynslope.bakzdelta, frac));
+			}
 			break;
 		}
 	}
@@ -683,9 +701,7 @@ void R_RestoreLevelInterpolators(void)
 			interp->polyobj.polyobj->centerPt.y = interp->polyobj.bakcy;
 			break;
 		case LVLINTERP_DynSlope:
-			FV3_Copy(&interp->dynslope.slope->o, &interp->dynslope.bako);
-			FV2_Copy(&interp->dynslope.slope->d, &interp->dynslope.bakd);
-			interp->dynslope.slope->zdelta = interp->dynslope.bakzdelta;
+			R_SetDynSlope(interp->dynslope.slope, &interp->dynslope.bako, &interp->dynslope.bakd, interp->dynslope.bakzdelta);
 			break;
 		}
 	}
@@ -107,11 +107,22 @@ ps_metric_t ps_sw_spritecliptime = {0};
 ps_metric_t ps_sw_portaltime = {0};
 ps_metric_t ps_sw_planetime = {0};
 ps_metric_t ps_sw_maskedtime = {0};
+ps_metric_t ps_sw_spritesorttime = {0};
 
 ps_metric_t ps_numbspcalls = {0};
 ps_metric_t ps_numsprites = {0};
 ps_metric_t ps_numdrawnodes = {0};
 ps_metric_t ps_numpolyobjects = {0};
+ps_metric_t ps_spritesoccluded = {0};
+ps_metric_t ps_spritesclipped = {0};
+
+ps_metric_t ps_rotsprite_hits = {0};
+ps_metric_t ps_rotsprite_misses = {0};
+ps_metric_t ps_rotsprite_memory = {0};
+
+ps_metric_t ps_numvisplanes = {0};
+ps_metric_t ps_visplanemerges = {0};
+ps_metric_t ps_visplanechain = {0};
 
 static CV_PossibleValue_t drawdist_cons_t[] = {
 	{256, "256"},	{512, "512"},	{768, "768"},
@@ -129,6 +140,7 @@ static CV_PossibleValue_t drawdist_precip_cons_t[] = {
 static CV_PossibleValue_t fov_cons_t[] = {{60*FRACUNIT, "MIN"}, {179*FRACUNIT, "MAX"}, {0, NULL}};
 static CV_PossibleValue_t translucenthud_cons_t[] = {{0, "MIN"}, {10, "MAX"}, {0, NULL}};
 static CV_PossibleValue_t maxportals_cons_t[] = {{0, "MIN"}, {12, "MAX"}, {0, NULL}}; // lmao rendering 32 portals, you're a card
+static CV_PossibleValue_t texturecache_cons_t[] = {{0, "MIN"}, {4096, "MAX"}, {0, NULL}}; // MB, 0 for no limit
 static CV_PossibleValue_t homremoval_cons_t[] = {{0, "No"}, {1, "Yes"}, {2, "Flash"}, {0, NULL}};
 
 static void Fov_OnChange(void);
@@ -149,6 +161,9 @@ consvar_t cv_shadow = CVAR_INIT ("shadow", "On", CV_SAVE, CV_OnOff, NULL);
 consvar_t cv_skybox = CVAR_INIT ("skybox", "On", CV_SAVE, CV_OnOff, NULL);
 consvar_t cv_ffloorclip = CVAR_INIT ("r_ffloorclip", "On", CV_SAVE, CV_OnOff, NULL);
 consvar_t cv_spriteclip = CVAR_INIT ("r_spriteclip", "On", CV_SAVE, CV_OnOff, NULL);
+consvar_t cv_texturecache = CVAR_INIT ("r_texturecache", "0", CV_SAVE, texturecache_cons_t, NULL);
+consvar_t cv_mipmap = CVAR_INIT ("r_mipmap", "Off", CV_SAVE, CV_OnOff, NULL);
+consvar_t cv_rotspritecache = CVAR_INIT ("r_rotspritecache", "0", CV_SAVE, texturecache_cons_t, NULL);
 consvar_t cv_allowmlook = CVAR_INIT ("allowmlook", "Yes", CV_NETVAR|CV_ALLOWLUA, CV_YesNo, NULL);
 consvar_t cv_showhud = CVAR_INIT ("showhud", "Yes", CV_CALL|CV_ALLOWLUA,  CV_YesNo, R_SetViewSize);
 consvar_t cv_translucenthud = CVAR_INIT ("translucenthud", "10", CV_SAVE, translucenthud_cons_t, NULL);
@@ -1453,6 +1468,8 @@ void R_RenderPlayerView(player_t *player)
 	framecount++;
 	validcount++;
 
+	R_TrimTextureCache();
+
 	// Clear buffers.
 	R_ClearPlanes();
 	if (viewmorph.use)
@@ -1482,14 +1499,19 @@ void R_RenderPlayerView(player_t *player)
 	Mask_Pre(&masks[nummasks - 1]);
 	curdrawsegs = ds_p;
 	ps_numbspcalls.value.i = ps_numpolyobjects.value.i = ps_numdrawnodes.value.i = 0;
+	ps_spritesoccluded.value.i = ps_spritesclipped.value.i = 0;
+	PS_TRACE_BEGIN("R_RenderBSPNode");
 	PS_START_TIMING(ps_bsptime);
 	R_RenderBSPNode((INT32)numnodes - 1);
 	PS_STOP_TIMING(ps_bsptime);
+	PS_TRACE_END("R_RenderBSPNode");
 	Mask_Post(&masks[nummasks - 1]);
 
+	PS_TRACE_BEGIN("R_ClipSprites");
 	PS_START_TIMING(ps_sw_spritecliptime);
 	R_ClipSprites(drawsegs, NULL);
 	PS_STOP_TIMING(ps_sw_spritecliptime);
+	PS_TRACE_END("R_ClipSprites");
 
 	ps_numsprites.value.i = numvisiblesprites;
 
@@ -1498,6 +1520,7 @@ void R_RenderPlayerView(player_t *player)
 		Portal_AddSkyboxPortals();
 
 	// Portal rendering. Hijacks the BSP traversal.
+	PS_TRACE_BEGIN("Portals");
 	PS_START_TIMING(ps_sw_portaltime);
 	if (portal_base)
 	{
@@ -1539,16 +1562,22 @@ void R_RenderPlayerView(player_t *player)
 		}
 	}
 	PS_STOP_TIMING(ps_sw_portaltime);
+	PS_TRACE_END("Portals");
 
+	PS_TRACE_BEGIN("R_DrawPlanes");
 	PS_START_TIMING(ps_sw_planetime);
 	R_DrawPlanes();
 	PS_STOP_TIMING(ps_sw_planetime);
+	PS_TRACE_END("R_DrawPlanes");
 
 	// draw mid texture and sprite
 	// And now 3D floors/sides!
+	PS_TRACE_BEGIN("R_DrawMasked");
+	ps_sw_spritesorttime.value.p = 0;
 	PS_START_TIMING(ps_sw_maskedtime);
 	R_DrawMasked(masks, nummasks);
 	PS_STOP_TIMING(ps_sw_maskedtime);
+	PS_TRACE_END("R_DrawMasked");
 
 	free(masks);
 }
@@ -1583,6 +1612,9 @@ void R_RegisterEngineStuff(void)
 	CV_RegisterVar(&cv_skybox);
 	CV_RegisterVar(&cv_ffloorclip);
 	CV_RegisterVar(&cv_spriteclip);
+	CV_RegisterVar(&cv_texturecache);
+	CV_RegisterVar(&cv_mipmap);
+	CV_RegisterVar(&cv_rotspritecache);
 
 	CV_RegisterVar(&cv_cam_dist);
 	CV_RegisterVar(&cv_cam_still);
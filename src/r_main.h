@@ -98,11 +98,22 @@ extern ps_metric_t ps_sw_spritecliptime;
 extern ps_metric_t ps_sw_portaltime;
 extern ps_metric_t ps_sw_planetime;
 extern ps_metric_t ps_sw_maskedtime;
+extern ps_metric_t ps_sw_spritesorttime;
 
 extern ps_metric_t ps_numbspcalls;
 extern ps_metric_t ps_numsprites;
 extern ps_metric_t ps_numdrawnodes;
 extern ps_metric_t ps_numpolyobjects;
+extern ps_metric_t ps_spritesoccluded;
+extern ps_metric_t ps_spritesclipped;
+
+extern ps_metric_t ps_rotsprite_hits;
+extern ps_metric_t ps_rotsprite_misses;
+extern ps_metric_t ps_rotsprite_memory;
+
+extern ps_metric_t ps_numvisplanes;
+extern ps_metric_t ps_visplanemerges;
+extern ps_metric_t ps_visplanechain;
 
 //
 // REFRESH - the actual rendering functions.
@@ -114,7 +125,7 @@ extern consvar_t cv_chasecam, cv_chasecam2;
 extern consvar_t cv_flipcam, cv_flipcam2;
 
 extern consvar_t cv_shadow;
-extern consvar_t cv_ffloorclip, cv_spriteclip;
+extern consvar_t cv_ffloorclip, cv_spriteclip, cv_texturecache, cv_mipmap, cv_rotspritecache;
 extern consvar_t cv_translucency;
 extern consvar_t cv_drawdist, cv_drawdist_nights, cv_drawdist_precip;
 extern consvar_t cv_fov;
@@ -12,6 +12,7 @@
 #include "doomdef.h"
 #include "r_patch.h"
 #include "r_picformats.h"
+#include "r_patchrotation.h" // RotatedPatch_Forget, RotatedPatch_FlushCache
 #include "r_defs.h"
 #include "z_zone.h"
 
@@ -85,6 +86,8 @@ static void Patch_FreeData(patch_t *patch)
 	{
 		rotsprite_t *rotsprite = patch->rotated;
 
+		RotatedPatch_Forget(rotsprite);
+
 		for (i = 0; i < rotsprite->angles; i++)
 		{
 			if (rotsprite->patches[i])
@@ -92,6 +95,7 @@ static void Patch_FreeData(patch_t *patch)
 		}
 
 		Z_Free(rotsprite->patches);
+		Z_Free(rotsprite->lastused);
 		Z_Free(rotsprite);
 	}
 #endif
@@ -122,6 +126,10 @@ static boolean Patch_FreeTagsCallback(void *mem)
 void Patch_FreeTags(INT32 lowtag, INT32 hightag)
 {
 	Z_IterateTags(lowtag, hightag, Patch_FreeTagsCallback);
+#ifdef ROTSPRITE
+	if (lowtag <= PU_PATCH_ROTATED && hightag >= PU_PATCH_ROTATED)
+		RotatedPatch_FlushCache();
+#endif
 }
 
 void Patch_GenerateFlat(patch_t *patch, pictureflags_t flags)
@@ -13,7 +13,7 @@
 #include "r_things.h" // FEETADJUST
 #include "z_zone.h"
 #include "w_wad.h"
-#include "r_main.h" // R_PointToAngle
+#include "r_main.h" // R_PointToAngle, cv_rotspritecache
 
 #ifdef ROTSPRITE
 fixed_t rollcosang[ROTANGLES];
@@ -63,20 +63,171 @@ patch_t *Patch_GetRotated(patch_t *patch, INT32 angle, boolean flip)
 	return rotsprite->patches[angle];
 }
 
-patch_t *Patch_GetRotatedSprite(
+//
+// Rotated sprite cache
+// Every rotated sprite frame made by Patch_GetRotatedSprite is kept track of
+//  here, so that the least recently used ones can be freed once they take up
+//  more than r_rotspritecache allows. Angles next to the ones being drawn are
+//  queued up and made after the frame is rendered, so that rolling objects
+//  don't have to rotate a new patch in the middle of most frames.
+//
+
+typedef struct
+{
+	rotsprite_t *rotsprite;
+	INT32 idx;
+	patch_t *patch; // to tell if the entry is stale, after a level change freed it
+	size_t size;
+} rotcacheentry_t;
+
+static rotcacheentry_t *rotcache = NULL;
+static size_t rotcachecount = 0, rotcachesize = 0;
+static size_t rotcachememory = 0;
+static UINT32 rotcachetime = 1;
+
+// lastused of patches handed out to Lua, which scripts can keep for as long
+// as they like. Those are only freed along with the rest of PU_PATCH_ROTATED.
+#define ROTCACHE_PINNED UINT32_MAX
+static INT32 rotcachehits = 0, rotcachemisses = 0;
+
+typedef struct
+{
+	spriteframe_t *sprite;
+	size_t frame, spriteangle;
+	boolean flip, adjustfeet;
+	void *info;
+	INT32 rotationangle;
+} rotprefetch_t;
+
+#define MAXROTPREFETCH 64
+#define ROTPREFETCHPERFRAME 4
+#define ROTPREFETCHRANGE 2 // angle steps on either side
+
+static rotprefetch_t rotprefetch[MAXROTPREFETCH];
+static INT32 numrotprefetch = 0;
+
+static boolean RotatedPatch_IsCached(rotcacheentry_t *entry)
+{
+	return (entry->rotsprite->patches[entry->idx] == entry->patch);
+}
+
+// Memory taken up by a rotated patch, column posts included
+static size_t RotatedPatch_Size(const patch_t *patch)
+{
+	size_t end = 0;
+	INT32 x;
+
+	for (x = 0; x < patch->width; x++)
+	{
+		const UINT8 *column = patch->columns + patch->columnofs[x];
+
+		while (*column != 0xFF)
+			column += column[1] + 4;
+
+		end = max(end, (size_t)(column - patch->columns) + 1);
+	}
+
+	return sizeof (*patch) + (patch->width * sizeof (*patch->columnofs)) + end;
+}
+
+static void RotatedPatch_AddToCache(rotsprite_t *rotsprite, INT32 idx)
+{
+	patch_t *patch = rotsprite->patches[idx];
+	rotcacheentry_t *entry;
+
+	if (rotcachecount == rotcachesize)
+	{
+		size_t i, live = 0;
+
+		// Drop entries whose patches were freed elsewhere first
+		for (i = 0; i < rotcachecount; i++)
+		{
+			if (RotatedPatch_IsCached(&rotcache[i]))
+				rotcache[live++] = rotcache[i];
+			else
+				rotcachememory -= min(rotcache[i].size, rotcachememory);
+		}
+		rotcachecount = live;
+
+		if (rotcachecount == rotcachesize)
+		{
+			rotcachesize = rotcachesize ? rotcachesize * 2 : 256;
+			rotcache = Z_Realloc(rotcache, rotcachesize * sizeof (*rotcache), PU_STATIC, NULL);
+		}
+	}
+
+	entry = &rotcache[rotcachecount++];
+	entry->rotsprite = rotsprite;
+	entry->idx = idx;
+	entry->patch = patch;
+	entry->size = RotatedPatch_Size(patch);
+
+	rotcachememory += entry->size;
+}
+
+static int RotatedPatch_CompareLastUse(const void *a, const void *b)
+{
+	const rotcacheentry_t *ea = a, *eb = b;
+	UINT32 ua = ea->rotsprite->lastused[ea->idx];
+	UINT32 ub = eb->rotsprite->lastused[eb->idx];
+	return (ua > ub) - (ua < ub);
+}
+
+//
+// RotatedPatch_TrimCache
+//
+// Frees the least recently used rotated patches, down to a bit under the
+// budget. Nothing but Lua can be holding on to any of them when this is
+// called, and the ones it was given are pinned.
+//
+static void RotatedPatch_TrimCache(size_t budget)
+{
+	size_t i, live = 0;
+	INT32 freed = 0;
+
+	for (i = 0; i < rotcachecount; i++)
+	{
+		if (RotatedPatch_IsCached(&rotcache[i]))
+			rotcache[live++] = rotcache[i];
+		else
+			rotcachememory -= min(rotcache[i].size, rotcachememory);
+	}
+	rotcachecount = live;
+
+	if (rotcachememory <= budget)
+		return;
+
+	qsort(rotcache, rotcachecount, sizeof (*rotcache), RotatedPatch_CompareLastUse);
+
+	budget -= budget >> 3;
+	for (i = 0; i < rotcachecount && rotcachememory > budget; i++)
+	{
+		UINT32 lastused = rotcache[i].rotsprite->lastused[rotcache[i].idx];
+		if (lastused == rotcachetime || lastused == ROTCACHE_PINNED)
+			break; // the rest were used this frame, or are pinned
+
+		Patch_Free(rotcache[i].patch);
+		rotcachememory -= min(rotcache[i].size, rotcachememory);
+		freed++;
+	}
+
+	rotcachecount -= i;
+	memmove(rotcache, rotcache + i, rotcachecount * sizeof (*rotcache));
+
+	CONS_Debug(DBG_RENDER, "RotatedPatch_TrimCache: freed %d patches, %s KB still cached\n", freed, sizeu1(rotcachememory>>10));
+}
+
+static patch_t *RotatedPatch_CacheSprite(
 	spriteframe_t *sprite,
 	size_t frame, size_t spriteangle,
 	boolean flip, boolean adjustfeet,
-	void *info, INT32 rotationangle)
+	spriteinfo_t *sprinfo, INT32 rotationangle,
+	boolean *generated)
 {
 	rotsprite_t *rotsprite;
-	spriteinfo_t *sprinfo = (spriteinfo_t *)info;
 	INT32 idx = rotationangle;
 	UINT8 type = (adjustfeet ? 1 : 0);
 
-	if (rotationangle < 1 || rotationangle >= ROTANGLES)
-		return NULL;
-
 	rotsprite = sprite->rotated[type][spriteangle];
 
 	if (rotsprite == NULL)
@@ -88,6 +239,8 @@ patch_t *Patch_GetRotatedSprite(
 	if (flip)
 		idx += rotsprite->angles;
 
+	*generated = false;
+
 	if (rotsprite->patches[idx] == NULL)
 	{
 		patch_t *patch;
@@ -115,11 +268,175 @@ patch_t *Patch_GetRotatedSprite(
 		//BP: we cannot use special tric in hardware mode because feet in ground caused by z-buffer
 		if (adjustfeet)
 			((patch_t *)rotsprite->patches[idx])->topoffset += FEETADJUST>>FRACBITS;
+
+		RotatedPatch_AddToCache(rotsprite, idx);
+		rotsprite->lastused[idx] = 0; // the pin went with the previous patch
+		*generated = true;
 	}
 
+	if (rotsprite->lastused[idx] != ROTCACHE_PINNED)
+		rotsprite->lastused[idx] = rotcachetime;
+
 	return rotsprite->patches[idx];
 }
 
+static void RotatedPatch_QueuePrefetch(
+	spriteframe_t *sprite,
+	size_t frame, size_t spriteangle,
+	boolean flip, boolean adjustfeet,
+	void *info, INT32 rotationangle)
+{
+	rotsprite_t *rotsprite = sprite->rotated[(adjustfeet ? 1 : 0)][spriteangle];
+	INT32 i, j;
+
+	for (i = -ROTPREFETCHRANGE; i <= ROTPREFETCHRANGE; i++)
+	{
+		INT32 angle = (rotationangle + i + ROTANGLES) % ROTANGLES;
+		rotprefetch_t *prefetch;
+
+		if (angle < 1 || (rotsprite && rotsprite->patches[angle + (flip ? rotsprite->angles : 0)]))
+			continue;
+
+		for (j = 0; j < numrotprefetch; j++)
+		{
+			prefetch = &rotprefetch[j];
+			if (prefetch->sprite == sprite && prefetch->spriteangle == spriteangle && prefetch->rotationangle == angle
+			&& prefetch->flip == flip && prefetch->adjustfeet == adjustfeet)
+				break;
+		}
+
+		if (j < numrotprefetch)
+			continue;
+
+		if (numrotprefetch == MAXROTPREFETCH)
+			return;
+
+		prefetch = &rotprefetch[numrotprefetch++];
+		prefetch->sprite = sprite;
+		prefetch->frame = frame;
+		prefetch->spriteangle = spriteangle;
+		prefetch->flip = flip;
+		prefetch->adjustfeet = adjustfeet;
+		prefetch->info = info;
+		prefetch->rotationangle = angle;
+	}
+}
+
+//
+// RotatedPatch_Forget
+//
+// Call before freeing a rotsprite_t, so that the cache doesn't keep on
+// pointing into it. The prefetch queue is dropped too, since it may hold
+// on to the sprite frames being freed along with it.
+//
+void RotatedPatch_Forget(rotsprite_t *rotsprite)
+{
+	size_t i, live = 0;
+
+	for (i = 0; i < rotcachecount; i++)
+	{
+		if (rotcache[i].rotsprite != rotsprite)
+			rotcache[live++] = rotcache[i];
+		else
+			rotcachememory -= min(rotcache[i].size, rotcachememory);
+	}
+	rotcachecount = live;
+
+	numrotprefetch = 0;
+}
+
+//
+// RotatedPatch_FlushCache
+//
+// Call after freeing PU_PATCH_ROTATED, which takes every cached patch with it.
+//
+void RotatedPatch_FlushCache(void)
+{
+	rotcachecount = 0;
+	rotcachememory = 0;
+	numrotprefetch = 0;
+}
+
+//
+// RotatedPatch_UpdateCache
+//
+// Call once per frame, after the views are rendered. Makes some of the
+// queued up rotations, keeps the cache within its budget and updates the
+// perfstats counters.
+//
+void RotatedPatch_UpdateCache(void)
+{
+	size_t budget = (size_t)cv_rotspritecache.value << 20;
+	INT32 i;
+
+	for (i = 0; i < numrotprefetch && i < ROTPREFETCHPERFRAME; i++)
+	{
+		rotprefetch_t *prefetch = &rotprefetch[i];
+		boolean generated;
+
+		RotatedPatch_CacheSprite(prefetch->sprite, prefetch->frame, prefetch->spriteangle,
+			prefetch->flip, prefetch->adjustfeet, prefetch->info, prefetch->rotationangle, &generated);
+	}
+
+	// Whatever didn't make it is queued again if it's still needed;
+	// sprite frames can go away between frames.
+	numrotprefetch = 0;
+
+	if (budget && rotcachememory > budget)
+		RotatedPatch_TrimCache(budget);
+
+	ps_rotsprite_hits.value.i = rotcachehits;
+	ps_rotsprite_misses.value.i = rotcachemisses;
+	ps_rotsprite_memory.value.i = (INT32)(rotcachememory >> 10);
+	rotcachehits = rotcachemisses = 0;
+
+	rotcachetime++;
+}
+
+patch_t *Patch_GetRotatedSprite(
+	spriteframe_t *sprite,
+	size_t frame, size_t spriteangle,
+	boolean flip, boolean adjustfeet,
+	void *info, INT32 rotationangle)
+{
+	patch_t *patch;
+	boolean generated;
+
+	if (rotationangle < 1 || rotationangle >= ROTANGLES)
+		return NULL;
+
+	patch = RotatedPatch_CacheSprite(sprite, frame, spriteangle, flip, adjustfeet, info, rotationangle, &generated);
+
+	if (generated)
+		rotcachemisses++;
+	else if (patch)
+		rotcachehits++;
+
+	if (patch)
+		RotatedPatch_QueuePrefetch(sprite, frame, spriteangle, flip, adjustfeet, info, rotationangle);
+
+	return patch;
+}
+
+// Same as Patch_GetRotatedSprite, for patches that are handed out to Lua.
+// The patch is pinned, so RotatedPatch_TrimCache never frees it.
+patch_t *Patch_GetPinnedRotatedSprite(
+	spriteframe_t *sprite,
+	size_t frame, size_t spriteangle,
+	boolean flip, boolean adjustfeet,
+	void *info, INT32 rotationangle)
+{
+	patch_t *patch = Patch_GetRotatedSprite(sprite, frame, spriteangle, flip, adjustfeet, info, rotationangle);
+
+	if (patch)
+	{
+		rotsprite_t *rotsprite = sprite->rotated[(adjustfeet ? 1 : 0)][spriteangle];
+		rotsprite->lastused[rotationangle + (flip ? rotsprite->angles : 0)] = ROTCACHE_PINNED;
+	}
+
+	return patch;
+}
+
 void Patch_Rotate(patch_t *patch, INT32 angle, INT32 xpivot, INT32 ypivot, boolean flip)
 {
 	if (patch->rotated == NULL)
@@ -132,6 +449,7 @@ rotsprite_t *RotatedPatch_Create(INT32 numangles)
 	rotsprite_t *rotsprite = Z_Calloc(sizeof(rotsprite_t), PU_STATIC, NULL);
 	rotsprite->angles = numangles;
 	rotsprite->patches = Z_Calloc(rotsprite->angles * 2 * sizeof(void *), PU_STATIC, NULL);
+	rotsprite->lastused = Z_Calloc(rotsprite->angles * 2 * sizeof(UINT32), PU_STATIC, NULL);
 	return rotsprite;
 }
 
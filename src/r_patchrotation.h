@@ -15,6 +15,9 @@
 #ifdef ROTSPRITE
 rotsprite_t *RotatedPatch_Create(INT32 numangles);
 void RotatedPatch_DoRotation(rotsprite_t *rotsprite, patch_t *patch, INT32 angle, INT32 xpivot, INT32 ypivot, boolean flip);
+void RotatedPatch_UpdateCache(void);
+void RotatedPatch_FlushCache(void);
+void RotatedPatch_Forget(rotsprite_t *rotsprite);
 
 extern fixed_t rollcosang[ROTANGLES];
 extern fixed_t rollsinang[ROTANGLES];
@@ -12,9 +12,14 @@
 /// \file  r_picformats.c
 /// \brief Picture generation.
 
+#include "doomdef.h"
 #include "byteptr.h"
 #include "dehacked.h"
+#include "d_main.h" // srb2home
+#include "filesrch.h" // prunecachedirectory, touchcachefile
+#include "i_system.h" // I_mkdir
 #include "i_video.h"
+#include "m_argv.h"
 #include "r_data.h"
 #include "r_patch.h"
 #include "r_picformats.h"
@@ -51,12 +56,6 @@
 #endif
 #endif
 
-static unsigned char imgbuf[1<<26];
-
-#ifdef PICTURE_PNG_USELOOKUP
-static colorlookup_t png_colorlookup;
-#endif
-
 /** Converts a picture between two formats.
   *
   * \param informat Input picture format.
@@ -117,8 +116,7 @@ void *Picture_PatchConvert(
 	pictureflags_t flags)
 {
 	INT16 x, y;
-	UINT8 *img;
-	UINT8 *imgptr = imgbuf;
+	UINT8 *img, *imgbuf, *imgptr;
 	UINT8 *colpointers, *startofspan;
 	size_t size = 0;
 	patch_t *inpatch = NULL;
@@ -160,6 +158,23 @@ void *Picture_PatchConvert(
 		}
 	}
 
+	// A damaged header can hold negative dimensions, which would
+	// otherwise turn into a huge allocation below.
+	if (inwidth < 0 || inheight < 0)
+	{
+		CONS_Debug(DBG_RENDER, "Picture_PatchConvert: invalid dimensions %dx%d\n", inwidth, inheight);
+		inwidth = inheight = 0;
+	}
+
+	// Every span costs at most four bytes on top of its pixels, a column
+	// has at most one span per two pixels plus the ones forced by the
+	// 254 and 255 limits, and ends with one more byte.
+	size = 8 + (size_t)inwidth*4;
+	size += (size_t)inwidth * ((size_t)inheight * (Picture_FormatBPP(outformat)/8 + 4) + 17);
+	imgbuf = imgptr = malloc(size);
+	if (imgbuf == NULL)
+		I_Error("Picture_PatchConvert: couldn't allocate %s bytes", sizeu1(size));
+
 	// Write image size and offset
 	WRITEINT16(imgptr, inwidth);
 	WRITEINT16(imgptr, inheight);
@@ -351,6 +366,7 @@ void *Picture_PatchConvert(
 	size = imgptr-imgbuf;
 	img = Z_Malloc(size, PU_STATIC, NULL);
 	memcpy(img, imgbuf, size);
+	free(imgbuf);
 
 	if (Picture_IsInternalPatchFormat(outformat))
 	{
@@ -857,18 +873,21 @@ typedef struct
 	size_t size;
 } png_chunk_t;
 
-static png_byte *chunkname = NULL;
-static png_chunk_t chunk;
+static png_byte grAb_chunk[5] = {'g', 'r', 'A', 'b', (png_byte)'\0'};
 
+// The chunk being read is kept by the caller and handed to libpng as the
+// user chunk pointer, so that separate PNGs can be read at the same time.
 static int PNG_ChunkReader(png_structp png_ptr, png_unknown_chunkp chonk)
 {
-	(void)png_ptr;
-	if (!memcmp(chonk->name, chunkname, 4))
+	png_chunk_t *chunk = png_get_user_chunk_ptr(png_ptr);
+	if (!memcmp(chonk->name, grAb_chunk, 4) && chunk->data == NULL)
 	{
-		memcpy(chunk.name, chonk->name, 4);
-		chunk.size = chonk->size;
-		chunk.data = Z_Malloc(chunk.size, PU_STATIC, NULL);
-		memcpy(chunk.data, chonk->data, chunk.size);
+		memcpy(chunk->name, chonk->name, 4);
+		chunk->size = chonk->size;
+		chunk->data = malloc(chunk->size);
+		if (chunk->data == NULL)
+			png_error(png_ptr, "PNG_ChunkReader: out of memory");
+		memcpy(chunk->data, chonk->data, chunk->size);
 		return 1;
 	}
 	return 0;
@@ -885,8 +904,6 @@ static void PNG_warn(png_structp PNG, png_const_charp pngtext)
 	CONS_Debug(DBG_RENDER, "libpng warning at %p: %s", PNG, pngtext);
 }
 
-static png_byte grAb_chunk[5] = {'g', 'r', 'A', 'b', (png_byte)'\0'};
-
 static png_bytep *PNG_Read(
 	const UINT8 *png,
 	INT32 *w, INT32 *h, INT16 *topoffset, INT16 *leftoffset,
@@ -911,8 +928,8 @@ static png_bytep *PNG_Read(
 #endif
 
 	png_io_t png_io;
+	png_chunk_t chunk;
 	png_bytep *row_pointers;
-	png_voidp *user_chunk_ptr;
 
 	png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, PNG_error, PNG_warn);
 	if (!png_ptr)
@@ -925,6 +942,8 @@ static png_bytep *PNG_Read(
 		I_Error("PNG_Read: libpng couldn't allocate memory!");
 	}
 
+	memset(&chunk, 0x00, sizeof(png_chunk_t));
+
 #ifdef USE_FAR_KEYWORD
 	if (setjmp(jmpbuf))
 #else
@@ -932,6 +951,8 @@ static png_bytep *PNG_Read(
 #endif
 	{
 		png_destroy_read_struct(&png_ptr, &png_info_ptr, NULL);
+		if (chunk.data)
+			free(chunk.data);
 		I_Error("PNG_Read: libpng load error!");
 	}
 #ifdef USE_FAR_KEYWORD
@@ -943,12 +964,9 @@ static png_bytep *PNG_Read(
 	png_io.position = 0;
 	png_set_read_fn(png_ptr, &png_io, PNG_IOReader);
 
-	memset(&chunk, 0x00, sizeof(png_chunk_t));
-	chunkname = grAb_chunk; // I want to read a grAb chunk
-
-	user_chunk_ptr = png_get_user_chunk_ptr(png_ptr);
-	png_set_read_user_chunk_fn(png_ptr, user_chunk_ptr, PNG_ChunkReader);
-	png_set_keep_unknown_chunks(png_ptr, 2, chunkname, 1);
+	// I want to read a grAb chunk
+	png_set_read_user_chunk_fn(png_ptr, &chunk, PNG_ChunkReader);
+	png_set_keep_unknown_chunks(png_ptr, 2, grAb_chunk, 1);
 
 #ifdef PNG_SET_USER_LIMITS_SUPPORTED
 	png_set_user_limits(png_ptr, 2048, 2048);
@@ -957,6 +975,10 @@ static png_bytep *PNG_Read(
 	png_read_info(png_ptr, png_info_ptr);
 	png_get_IHDR(png_ptr, png_info_ptr, &width, &height, &bit_depth, &color_type, NULL, NULL, NULL);
 
+	// Patches store their dimensions as INT16
+	if (width > INT16_MAX || height > INT16_MAX)
+		png_error(png_ptr, "PNG_Read: image too large");
+
 	if (bit_depth == 16)
 		png_set_strip_16(png_ptr);
 
@@ -1042,7 +1064,7 @@ static png_bytep *PNG_Read(
 	png_read_image(png_ptr, row_pointers);
 
 	// Read grAB chunk
-	if ((topoffset || leftoffset) && (chunk.data != NULL))
+	if ((topoffset || leftoffset) && chunk.data != NULL && chunk.size >= 8)
 	{
 		INT32 *offsets = (INT32 *)chunk.data;
 		// read left offset
@@ -1056,7 +1078,7 @@ static png_bytep *PNG_Read(
 
 	png_destroy_read_struct(&png_ptr, &png_info_ptr, NULL);
 	if (chunk.data)
-		Z_Free(chunk.data);
+		free(chunk.data);
 
 	*w = (INT32)width;
 	*h = (INT32)height;
@@ -1064,20 +1086,61 @@ static png_bytep *PNG_Read(
 	return row_pointers;
 }
 
-/** Converts a PNG to a picture.
-  *
-  * \param png The PNG image.
-  * \param outformat The output picture's format.
-  * \param w The output picture's width, as a pointer.
-  * \param h The output picture's height, as a pointer.
-  * \param topoffset The output picture's top offset, for sprites, as a pointer.
-  * \param leftoffset The output picture's left offset, for sprites, as a pointer.
-  * \param insize The input picture's size.
-  * \param outsize A pointer to the output picture's size.
-  * \param flags Input picture flags.
-  * \return A pointer to the converted picture.
-  */
-void *Picture_PNGConvert(
+// Row converters for PNG_Convert. libpng hands out rows as RGBA bytes,
+// which is the same memory layout as RGBA_t, so whole pixels are moved
+// and compared as 32-bit words instead of one channel at a time.
+static void PNG_RowToRGBA(const UINT32 *in, UINT32 *out, png_uint_32 width)
+{
+	png_uint_32 x;
+
+	for (x = 0; x < width; x++)
+		out[x] = ((const UINT8 *)&in[x])[3] ? in[x] : 0x00000000;
+}
+
+// Sprites mostly come in runs of one colour, so the palette index found
+// for a pixel is reused for as long as the following pixels match it.
+// Fully transparent pixels are 0x0000 in 16bpp and left alone in 8bpp.
+static void PNG_RowToPalette(const UINT32 *in, void *out, png_uint_32 width, INT32 outbpp, colorlookup_t *lut)
+{
+	UINT16 *out16 = out;
+	UINT8 *out8 = out;
+	UINT32 last = 0;
+	UINT8 lastidx = 0;
+	boolean havelast = false;
+	png_uint_32 x;
+
+	for (x = 0; x < width; x++)
+	{
+		const UINT8 *px = (const UINT8 *)&in[x];
+
+		if (!px[3])
+		{
+			if (outbpp == PICDEPTH_16BPP)
+				out16[x] = 0x0000;
+			continue;
+		}
+
+		if (!havelast || in[x] != last)
+		{
+#ifdef PICTURE_PNG_USELOOKUP
+			lastidx = GetColorLUT(lut, px[0], px[1], px[2]);
+#else
+			(void)lut;
+			lastidx = NearestColor(px[0], px[1], px[2]);
+#endif
+			last = in[x];
+			havelast = true;
+		}
+
+		if (outbpp == PICDEPTH_16BPP)
+			out16[x] = (0xFF << 8) | lastidx;
+		else
+			out8[x] = lastidx;
+	}
+}
+
+// Decodes and converts a PNG; see Picture_PNGConvert.
+static void *PNG_Convert(
 	const UINT8 *png, pictureformat_t outformat,
 	INT32 *w, INT32 *h,
 	INT16 *topoffset, INT16 *leftoffset,
@@ -1092,12 +1155,13 @@ void *Picture_PNGConvert(
 	boolean palette = false;
 	png_bytep *row_pointers = NULL;
 	png_uint_32 width, height;
+	colorlookup_t *lut = NULL;
 
 	INT32 pngwidth, pngheight;
 	INT16 loffs = 0, toffs = 0;
 
 	if (png == NULL)
-		I_Error("Picture_PNGConvert: picture was NULL!");
+		I_Error("PNG_Convert: picture was NULL!");
 
 	if (w == NULL)
 		w = &pngwidth;
@@ -1113,7 +1177,7 @@ void *Picture_PNGConvert(
 	height = *h;
 
 	if (row_pointers == NULL)
-		I_Error("Picture_PNGConvert: row_pointers was NULL!");
+		I_Error("PNG_Convert: row_pointers was NULL!");
 
 	// Find the output format's bits per pixel amount
 	outbpp = Picture_FormatBPP(outformat);
@@ -1128,7 +1192,7 @@ void *Picture_PNGConvert(
 
 	// Shouldn't happen.
 	if (outbpp == PICDEPTH_NONE)
-		I_Error("Picture_PNGConvert: unknown output bits per pixel?!");
+		I_Error("PNG_Convert: unknown output bits per pixel?!");
 
 	// Figure out the size
 	flatsize = (width * height) * (outbpp / 8);
@@ -1143,127 +1207,62 @@ void *Picture_PNGConvert(
 		memset(flat, TRANSPARENTPIXEL, (width * height));
 
 #ifdef PICTURE_PNG_USELOOKUP
-	if (outbpp != PICDEPTH_32BPP)
-		InitColorLUT(&png_colorlookup, pMasterPalette, false);
+	// Each conversion has its own table, so that no state is shared
+	// between decodes. It is filled lazily, with only the colours the
+	// picture actually uses.
+	if (outbpp != PICDEPTH_32BPP && !palette)
+	{
+		lut = malloc(sizeof (*lut));
+		if (lut == NULL)
+			I_Error("PNG_Convert: couldn't allocate the colour lookup table");
+		lut->init = false;
+		InitColorLUT(lut, pMasterPalette, false);
+	}
 #endif
 
 	if (outbpp == PICDEPTH_32BPP)
 	{
-		RGBA_t out;
 		UINT32 *outflat = (UINT32 *)flat;
 
-		if (palette)
-		{
-			for (y = 0; y < height; y++)
-			{
-				row = row_pointers[y];
-				for (x = 0; x < width; x++)
-				{
-					out = V_GetColor(row[x]);
-					outflat[((y * width) + x)] = out.rgba;
-				}
-			}
-		}
-		else
+		for (y = 0; y < height; y++, outflat += width)
 		{
-			for (y = 0; y < height; y++)
+			row = row_pointers[y];
+			if (palette)
 			{
-				row = row_pointers[y];
 				for (x = 0; x < width; x++)
-				{
-					png_bytep px = &(row[x * 4]);
-					if ((UINT8)px[3])
-					{
-						out.s.red = (UINT8)px[0];
-						out.s.green = (UINT8)px[1];
-						out.s.blue = (UINT8)px[2];
-						out.s.alpha = (UINT8)px[3];
-						outflat[((y * width) + x)] = out.rgba;
-					}
-					else
-						outflat[((y * width) + x)] = 0x00000000;
-				}
+					outflat[x] = V_GetColor(row[x]).rgba;
 			}
+			else
+				PNG_RowToRGBA((const UINT32 *)row, outflat, width);
 		}
 	}
 	else if (outbpp == PICDEPTH_16BPP)
 	{
 		UINT16 *outflat = (UINT16 *)flat;
 
-		if (palette)
+		for (y = 0; y < height; y++, outflat += width)
 		{
-			for (y = 0; y < height; y++)
+			row = row_pointers[y];
+			if (palette)
 			{
-				row = row_pointers[y];
 				for (x = 0; x < width; x++)
-					outflat[((y * width) + x)] = (0xFF << 8) | row[x];
-			}
-		}
-		else
-		{
-			for (y = 0; y < height; y++)
-			{
-				row = row_pointers[y];
-				for (x = 0; x < width; x++)
-				{
-					png_bytep px = &(row[x * 4]);
-					UINT8 red = (UINT8)px[0];
-					UINT8 green = (UINT8)px[1];
-					UINT8 blue = (UINT8)px[2];
-					UINT8 alpha = (UINT8)px[3];
-
-					if (alpha)
-					{
-#ifdef PICTURE_PNG_USELOOKUP
-						UINT8 palidx = GetColorLUT(&png_colorlookup, red, green, blue);
-#else
-						UINT8 palidx = NearestColor(red, green, blue);
-#endif
-						outflat[((y * width) + x)] = (0xFF << 8) | palidx;
-					}
-					else
-						outflat[((y * width) + x)] = 0x0000;
-				}
+					outflat[x] = (0xFF << 8) | row[x];
 			}
+			else
+				PNG_RowToPalette((const UINT32 *)row, outflat, width, PICDEPTH_16BPP, lut);
 		}
 	}
 	else // 8bpp
 	{
 		UINT8 *outflat = (UINT8 *)flat;
 
-		if (palette)
-		{
-			for (y = 0; y < height; y++)
-			{
-				row = row_pointers[y];
-				for (x = 0; x < width; x++)
-					outflat[((y * width) + x)] = row[x];
-			}
-		}
-		else
+		for (y = 0; y < height; y++, outflat += width)
 		{
-			for (y = 0; y < height; y++)
-			{
-				row = row_pointers[y];
-				for (x = 0; x < width; x++)
-				{
-					png_bytep px = &(row[x * 4]);
-					UINT8 red = (UINT8)px[0];
-					UINT8 green = (UINT8)px[1];
-					UINT8 blue = (UINT8)px[2];
-					UINT8 alpha = (UINT8)px[3];
-
-					if (alpha)
-					{
-#ifdef PICTURE_PNG_USELOOKUP
-						UINT8 palidx = GetColorLUT(&png_colorlookup, red, green, blue);
-#else
-						UINT8 palidx = NearestColor(red, green, blue);
-#endif
-						outflat[((y * width) + x)] = palidx;
-					}
-				}
-			}
+			row = row_pointers[y];
+			if (palette)
+				memcpy(outflat, row, width);
+			else
+				PNG_RowToPalette((const UINT32 *)row, outflat, width, PICDEPTH_8BPP, lut);
 		}
 	}
 
@@ -1271,6 +1270,7 @@ void *Picture_PNGConvert(
 	for (y = 0; y < height; y++)
 		free(row_pointers[y]);
 	free(row_pointers);
+	free(lut);
 
 	// But wait, there's more!
 	if (Picture_IsPatchFormat(outformat))
@@ -1302,6 +1302,237 @@ void *Picture_PNGConvert(
 	return flat;
 }
 
+// Converted PNGs are cached in srb2home/pngcache, one file per picture.
+// Each file is a pngcacheheader_t followed by the converted picture. The
+// name of the file is the hash in the header, which covers everything
+// the conversion depends on: the PNG itself, the palette, the output
+// format and flags, and the offsets the caller passed in.
+#define PNGCACHE_DIR "pngcache"
+#define PNGCACHE_MAGIC "SRB2PNGC"
+#define PNGCACHE_MAXSIZE (128*1024*1024) // least recently used pictures are deleted past this
+
+typedef struct
+{
+	char magic[8];
+	char version[64]; // engine version and revision the picture was converted by
+	UINT64 hash;
+	UINT32 insize; // of the PNG
+	UINT32 outsize; // of the converted picture
+	INT32 width, height;
+	INT16 topoffset, leftoffset;
+} pngcacheheader_t;
+
+static UINT64 PNG_CacheHash(UINT64 hash, const void *data, size_t size)
+{
+	const UINT8 *p = data;
+	size_t i;
+
+	for (i = 0; i < size; i++)
+		hash = (hash ^ p[i]) * UINT64_C(0x100000001b3); // 64-bit FNV-1a
+	return hash;
+}
+
+static void PNG_CacheHeader(pngcacheheader_t *header,
+	const UINT8 *png, size_t insize, pictureformat_t outformat, pictureflags_t flags,
+	INT16 topoffset, INT16 leftoffset)
+{
+	UINT64 hash = UINT64_C(0xcbf29ce484222325);
+	INT32 params[4];
+
+	params[0] = outformat;
+	params[1] = flags;
+	params[2] = topoffset;
+	params[3] = leftoffset;
+
+	hash = PNG_CacheHash(hash, png, insize);
+	if (pMasterPalette)
+		hash = PNG_CacheHash(hash, pMasterPalette, sizeof (RGBA_t) * 256);
+	hash = PNG_CacheHash(hash, params, sizeof (params));
+
+	memset(header, 0, sizeof (*header));
+	memcpy(header->magic, PNGCACHE_MAGIC, sizeof (header->magic));
+	snprintf(header->version, sizeof (header->version), "%s %s", VERSIONSTRING, comprevision);
+	header->hash = hash;
+	header->insize = (UINT32)insize;
+}
+
+static void PNG_CachePath(char *path, size_t size, const pngcacheheader_t *header)
+{
+	snprintf(path, size, "%s" PATHSEP PNGCACHE_DIR PATHSEP "%08x%08x.pic", srb2home,
+		(UINT32)(header->hash >> 32), (UINT32)header->hash);
+}
+
+// Only flats and Doom patches can be checked against their header when
+// loaded back, so those are the only formats that get cached.
+static boolean PNG_IsCachedFormat(pictureformat_t format)
+{
+	return (Picture_IsFlatFormat(format) || format == PICFMT_DOOMPATCH);
+}
+
+/** Loads a converted picture from the PNG cache.
+  *
+  * \param header The header the cached file must match. The picture's
+  *               size, dimensions and offsets are filled in on success.
+  * \param outformat The format the picture was converted to.
+  * \return The converted picture, or NULL if there is no valid cached one.
+  */
+static void *PNG_LoadCached(pngcacheheader_t *header, pictureformat_t outformat)
+{
+	pngcacheheader_t cached;
+	char path[256+32];
+	FILE *handle;
+	void *picture;
+	long length;
+
+	PNG_CachePath(path, sizeof (path), header);
+	handle = fopen(path, "rb");
+	if (!handle)
+		return NULL;
+
+	if (fread(&cached, sizeof (cached), 1, handle) != 1
+	|| memcmp(cached.magic, header->magic, sizeof (cached.magic))
+	|| memcmp(cached.version, header->version, sizeof (cached.version))
+	|| cached.hash != header->hash || cached.insize != header->insize
+	|| !cached.outsize || cached.width <= 0 || cached.height <= 0
+	|| (Picture_IsFlatFormat(outformat)
+		&& cached.outsize != (UINT32)cached.width * cached.height * (Picture_FormatBPP(outformat) / 8))
+	|| fseek(handle, 0, SEEK_END) || (length = ftell(handle) - (long)sizeof (cached)) != (long)cached.outsize
+	|| fseek(handle, sizeof (cached), SEEK_SET))
+	{
+		fclose(handle);
+		return NULL;
+	}
+
+	picture = Z_Malloc(cached.outsize, PU_STATIC, NULL);
+	if (fread(picture, 1, cached.outsize, handle) != cached.outsize
+	|| (outformat == PICFMT_DOOMPATCH
+		&& (!Picture_CheckIfDoomPatch(picture, cached.outsize)
+		|| SHORT(((softwarepatch_t *)picture)->width) != cached.width
+		|| SHORT(((softwarepatch_t *)picture)->height) != cached.height)))
+	{
+		// Truncated or damaged; convert it again and overwrite it.
+		fclose(handle);
+		Z_Free(picture);
+		return NULL;
+	}
+	fclose(handle);
+
+	touchcachefile(path);
+	*header = cached;
+	return picture;
+}
+
+// Writes a converted picture to the PNG cache. The cache directory is
+// pruned down to PNGCACHE_MAXSIZE on the first write of a session, and
+// again every quarter of that written since.
+static void PNG_WriteCached(const pngcacheheader_t *header, const void *picture)
+{
+	static boolean madedir = false;
+	static size_t sinceprune = PNGCACHE_MAXSIZE;
+	char path[256+32];
+	char temppath[sizeof (path) + 4];
+	FILE *handle;
+	boolean ok;
+
+	if (!madedir)
+	{
+		I_mkdir(va("%s" PATHSEP PNGCACHE_DIR, srb2home), 0755);
+		madedir = true;
+	}
+
+	if (sinceprune >= PNGCACHE_MAXSIZE / 4)
+	{
+		prunecachedirectory(va("%s" PATHSEP PNGCACHE_DIR, srb2home), ".pic", PNGCACHE_MAXSIZE);
+		sinceprune = 0;
+	}
+
+	PNG_CachePath(path, sizeof (path), header);
+	snprintf(temppath, sizeof (temppath), "%s.tmp", path);
+
+	// Written under a temporary name first, so that a crash or a second
+	// instance never leaves a half-written picture under the real one.
+	handle = fopen(temppath, "wb");
+	if (!handle)
+		return;
+	ok = (fwrite(header, sizeof (*header), 1, handle) == 1
+		&& fwrite(picture, 1, header->outsize, handle) == header->outsize);
+	ok = (fclose(handle) == 0 && ok);
+	if (ok)
+		sinceprune += sizeof (*header) + header->outsize;
+
+	remove(path);
+	if (!ok || rename(temppath, path))
+		remove(temppath);
+}
+
+/** Converts a PNG to a picture.
+  *
+  * \param png The PNG image.
+  * \param outformat The output picture's format.
+  * \param w The output picture's width, as a pointer.
+  * \param h The output picture's height, as a pointer.
+  * \param topoffset The output picture's top offset, for sprites, as a pointer.
+  * \param leftoffset The output picture's left offset, for sprites, as a pointer.
+  * \param insize The input picture's size.
+  * \param outsize A pointer to the output picture's size.
+  * \param flags Input picture flags.
+  * \return A pointer to the converted picture.
+  * \note Converted flats and Doom patches are cached on disk, unless
+  *       -nopngcache was given.
+  */
+void *Picture_PNGConvert(
+	const UINT8 *png, pictureformat_t outformat,
+	INT32 *w, INT32 *h,
+	INT16 *topoffset, INT16 *leftoffset,
+	size_t insize, size_t *outsize,
+	pictureflags_t flags)
+{
+	static INT32 usecache = -1;
+	pngcacheheader_t header;
+	void *picture;
+	INT32 width, height;
+	INT16 toffs, loffs;
+	size_t size = 0;
+
+	if (png == NULL)
+		I_Error("Picture_PNGConvert: picture was NULL!");
+
+	if (usecache == -1)
+		usecache = !M_CheckParm("-nopngcache");
+
+	if (!usecache || !PNG_IsCachedFormat(outformat))
+		return PNG_Convert(png, outformat, w, h, topoffset, leftoffset, insize, outsize, flags);
+
+	toffs = topoffset ? *topoffset : 0;
+	loffs = leftoffset ? *leftoffset : 0;
+	PNG_CacheHeader(&header, png, insize, outformat, flags, toffs, loffs);
+
+	picture = PNG_LoadCached(&header, outformat);
+	if (picture == NULL)
+	{
+		picture = PNG_Convert(png, outformat, &width, &height, &toffs, &loffs, insize, &size, flags);
+
+		header.outsize = (UINT32)size;
+		header.width = width;
+		header.height = height;
+		header.topoffset = toffs;
+		header.leftoffset = loffs;
+		PNG_WriteCached(&header, picture);
+	}
+
+	if (w)
+		*w = header.width;
+	if (h)
+		*h = header.height;
+	if (topoffset)
+		*topoffset = header.topoffset;
+	if (leftoffset)
+		*leftoffset = header.leftoffset;
+	if (outsize)
+		*outsize = header.outsize;
+	return picture;
+}
+
 /** Returns the dimensions of a PNG image, but doesn't perform any conversions.
   *
   * \param png The PNG image.
@@ -1325,7 +1556,7 @@ boolean Picture_PNGDimensions(UINT8 *png, INT32 *width, INT32 *height, INT16 *to
 #endif
 
 	png_io_t png_io;
-	png_voidp *user_chunk_ptr;
+	png_chunk_t chunk;
 
 	png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, PNG_error, PNG_warn);
 	if (!png_ptr)
@@ -1338,6 +1569,8 @@ boolean Picture_PNGDimensions(UINT8 *png, INT32 *width, INT32 *height, INT16 *to
 		I_Error("Picture_PNGDimensions: libpng couldn't allocate memory!");
 	}
 
+	memset(&chunk, 0x00, sizeof(png_chunk_t));
+
 #ifdef USE_FAR_KEYWORD
 	if (setjmp(jmpbuf))
 #else
@@ -1345,6 +1578,8 @@ boolean Picture_PNGDimensions(UINT8 *png, INT32 *width, INT32 *height, INT16 *to
 #endif
 	{
 		png_destroy_read_struct(&png_ptr, &png_info_ptr, NULL);
+		if (chunk.data)
+			free(chunk.data);
 		I_Error("Picture_PNGDimensions: libpng load error!");
 	}
 #ifdef USE_FAR_KEYWORD
@@ -1356,12 +1591,9 @@ boolean Picture_PNGDimensions(UINT8 *png, INT32 *width, INT32 *height, INT16 *to
 	png_io.position = 0;
 	png_set_read_fn(png_ptr, &png_io, PNG_IOReader);
 
-	memset(&chunk, 0x00, sizeof(png_chunk_t));
-	chunkname = grAb_chunk; // I want to read a grAb chunk
-
-	user_chunk_ptr = png_get_user_chunk_ptr(png_ptr);
-	png_set_read_user_chunk_fn(png_ptr, user_chunk_ptr, PNG_ChunkReader);
-	png_set_keep_unknown_chunks(png_ptr, 2, chunkname, 1);
+	// I want to read a grAb chunk
+	png_set_read_user_chunk_fn(png_ptr, &chunk, PNG_ChunkReader);
+	png_set_keep_unknown_chunks(png_ptr, 2, grAb_chunk, 1);
 
 #ifdef PNG_SET_USER_LIMITS_SUPPORTED
 	png_set_user_limits(png_ptr, 2048, 2048);
@@ -1371,7 +1603,7 @@ boolean Picture_PNGDimensions(UINT8 *png, INT32 *width, INT32 *height, INT16 *to
 	png_get_IHDR(png_ptr, png_info_ptr, &w, &h, &bit_depth, &color_type, NULL, NULL, NULL);
 
 	// Read grAB chunk
-	if ((topoffset || leftoffset) && (chunk.data != NULL))
+	if ((topoffset || leftoffset) && chunk.data != NULL && chunk.size >= 8)
 	{
 		INT32 *offsets = (INT32 *)chunk.data;
 		// read left offset
@@ -1385,7 +1617,7 @@ boolean Picture_PNGDimensions(UINT8 *png, INT32 *width, INT32 *height, INT16 *to
 
 	png_destroy_read_struct(&png_ptr, &png_info_ptr, NULL);
 	if (chunk.data)
-		Z_Free(chunk.data);
+		free(chunk.data);
 
 	*width = (INT32)w;
 	*height = (INT32)h;
@@ -38,7 +38,10 @@
 
 //SoM: 3/23/2000: Use Boom visplane hashing.
 
-visplane_t *visplanes[MAXVISPLANES];
+visplane_t **visplanes;
+INT32 numvisplanelists; // hash buckets, plus the fof plane list
+static UINT32 visplanehashmask;
+static INT32 visplanescreated; // this frame's, to size the next frame's hash
 static visplane_t *freetail;
 static visplane_t **freehead = &freetail;
 
@@ -49,9 +52,25 @@ static visplane_t *currentplane;
 visffloor_t ffloor[MAXFFLOORS];
 INT32 numffloors;
 
-//SoM: 3/23/2000: Boom visplane hashing routine.
-#define visplane_hash(picnum,lightlevel,height) \
-  ((unsigned)((picnum)*3+(lightlevel)+(height)*7) & VISPLANEHASHMASK)
+// Hashes everything R_FindPlane compares that changes within a frame,
+// so planes that differ only by offsets, angle, colormap or slope
+// don't all end up in the same chain.
+static unsigned visplane_hash(fixed_t height, INT32 picnum, INT32 lightlevel,
+	fixed_t xoff, fixed_t yoff, angle_t plangle,
+	extracolormap_t *planecolormap, pslope_t *slope, polyobj_t *polyobj)
+{
+	UINT32 hash = (UINT32)picnum * 0x9E3779B1u;
+	hash = (hash ^ (UINT32)lightlevel) * 0x85EBCA6Bu;
+	hash = (hash ^ (UINT32)height) * 0xC2B2AE35u;
+	hash = (hash ^ (UINT32)xoff) * 0x9E3779B1u;
+	hash = (hash ^ (UINT32)yoff) * 0x85EBCA6Bu;
+	hash = (hash ^ (UINT32)plangle) * 0xC2B2AE35u;
+	hash = (hash ^ (UINT32)((size_t)planecolormap >> 4)) * 0x9E3779B1u;
+	hash = (hash ^ (UINT32)((size_t)slope >> 4)) * 0x85EBCA6Bu;
+	hash = (hash ^ (UINT32)((size_t)polyobj >> 4)) * 0xC2B2AE35u;
+	hash ^= hash >> 16;
+	return hash & visplanehashmask;
+}
 
 //
 // Clip values are the solid pixel bounding the range.
@@ -67,6 +86,25 @@ fixed_t frontscale[MAXVIDWIDTH];
 //
 static INT32 spanstart[MAXVIDHEIGHT];
 
+//
+// Spans aren't drawn as R_MakeSpans finds them. They're collected per row,
+// then R_DrawPlaneSpans draws each row in one go, so the row's distance,
+// steps and light only get worked out once for all of its spans. Planes
+// that are identical apart from where they are on screen share one pass.
+//
+typedef struct
+{
+	INT32 x1, x2;
+	INT32 next; // next span in the same row, -1 if none
+} planespan_t;
+
+static planespan_t *planespans;
+static INT32 numplanespans, maxplanespans;
+static INT32 planespanrows[MAXVIDHEIGHT]; // first span in each row, -1 if none
+static INT32 planespantop = INT32_MAX, planespanbottom = -1; // rows with spans in them
+
+typedef void (*planemapfunc_t)(INT32 y, INT32 span);
+
 //
 // texture mapping
 //
@@ -141,19 +179,43 @@ static void R_UpdatePlaneRipple(void)
 	planeripple.offset = ((leveltime-1)*140) + ((rendertimefrac*140) / FRACUNIT);
 }
 
-static void R_MapPlane(INT32 y, INT32 x1, INT32 x2)
+// Mipmapping of the flat of the plane being drawn
+static struct
+{
+	levelflat_t *levelflat;
+	UINT8 *source; // full size flat
+	INT32 size;
+	INT32 level, maxlevel;
+	boolean active;
+} planemip;
+
+//
+// R_SetPlaneMipLevel
+// Switches the span drawer over to another mip level of the current flat.
+//
+static void R_SetPlaneMipLevel(INT32 level)
 {
-	angle_t angle, planecos, planesin;
-	fixed_t distance = 0, span;
-	size_t pindex;
+	INT32 wanted;
 
-#ifdef RANGECHECK
-	if (x2 < x1 || x1 < 0 || x2 >= viewwidth || y > viewheight)
-		I_Error("R_MapPlane: %d, %d at %d", x1, x2, y);
-#endif
+	if (level > planemip.maxlevel)
+		level = planemip.maxlevel;
+	if (level == planemip.level)
+		return;
+
+	wanted = level;
+	ds_source = R_GetFlatMip(planemip.levelflat, planemip.source, planemip.size, &level);
+	if (level < wanted)
+		planemip.maxlevel = level;
 
-	if (x1 >= vid.width)
-		x1 = vid.width - 1;
+	planemip.level = level;
+	R_SetFlatVars((planemip.size >> level) * (planemip.size >> level));
+}
+
+static void R_MapPlane(INT32 y, INT32 span)
+{
+	angle_t angle, planecos, planesin;
+	fixed_t distance = 0, rowspan, xfrac, yfrac;
+	size_t pindex;
 
 	angle = (currentplane->viewangle + currentplane->plangle)>>ANGLETOFINESHIFT;
 	planecos = FINECOSINE(angle);
@@ -163,12 +225,12 @@ static void R_MapPlane(INT32 y, INT32 x1, INT32 x2)
 	{
 		cachedheight[y] = planeheight;
 		cacheddistance[y] = distance = FixedMul(planeheight, yslope[y]);
-		span = abs(centery - y);
+		rowspan = abs(centery - y);
 
-		if (span) // Don't divide by zero
+		if (rowspan) // Don't divide by zero
 		{
-			ds_xstep = FixedMul(planesin, planeheight) / span;
-			ds_ystep = FixedMul(planecos, planeheight) / span;
+			ds_xstep = FixedMul(planesin, planeheight) / rowspan;
+			ds_ystep = FixedMul(planecos, planeheight) / rowspan;
 		}
 		else
 			ds_xstep = ds_ystep = FRACUNIT;
@@ -183,13 +245,16 @@ static void R_MapPlane(INT32 y, INT32 x1, INT32 x2)
 		ds_ystep = cachedystep[y];
 	}
 
+	if (planemip.active)
+		R_SetPlaneMipLevel(R_MipLevelForStep((UINT32)max(abs(ds_xstep), abs(ds_ystep))));
+
 	// [RH] Instead of using the xtoviewangle array, I calculated the fractional values
 	// at the middle of the screen, then used the calculated ds_xstep and ds_ystep
 	// to step from those to the proper texture coordinate to start drawing at.
 	// That way, the texture coordinate is always calculated by its position
 	// on the screen and not by its position relative to the edge of the visplane.
-	ds_xfrac = xoffs + FixedMul(planecos, distance) + (x1 - centerx) * ds_xstep;
-	ds_yfrac = yoffs - FixedMul(planesin, distance) + (x1 - centerx) * ds_ystep;
+	xfrac = xoffs + FixedMul(planecos, distance);
+	yfrac = yoffs - FixedMul(planesin, distance);
 
 	// Water ripple effect
 	if (planeripple.active)
@@ -198,8 +263,8 @@ static void R_MapPlane(INT32 y, INT32 x1, INT32 x2)
 
 		R_CalculatePlaneRipple(currentplane->viewangle + currentplane->plangle);
 
-		ds_xfrac += planeripple.xfrac;
-		ds_yfrac += planeripple.yfrac;
+		xfrac += planeripple.xfrac;
+		yfrac += planeripple.yfrac;
 		ds_bgofs >>= FRACBITS;
 
 		if ((y + ds_bgofs) >= viewheight)
@@ -208,6 +273,14 @@ static void R_MapPlane(INT32 y, INT32 x1, INT32 x2)
 			ds_bgofs = -y;
 	}
 
+	if (planemip.active && planemip.level)
+	{
+		xfrac >>= planemip.level;
+		yfrac >>= planemip.level;
+		ds_xstep >>= planemip.level;
+		ds_ystep >>= planemip.level;
+	}
+
 	pindex = distance >> LIGHTZSHIFT;
 	if (pindex >= MAXLIGHTZ)
 		pindex = MAXLIGHTZ - 1;
@@ -217,22 +290,31 @@ static void R_MapPlane(INT32 y, INT32 x1, INT32 x2)
 		ds_colormap = currentplane->extra_colormap->colormap + (ds_colormap - colormaps);
 
 	ds_y = y;
-	ds_x1 = x1;
-	ds_x2 = x2;
 
-	spanfunc();
-}
+	for (; span != -1; span = planespans[span].next)
+	{
+		INT32 x1 = planespans[span].x1;
+		INT32 x2 = planespans[span].x2;
 
-static void R_MapTiltedPlane(INT32 y, INT32 x1, INT32 x2)
-{
 #ifdef RANGECHECK
-	if (x2 < x1 || x1 < 0 || x2 >= viewwidth || y > viewheight)
-		I_Error("R_MapTiltedPlane: %d, %d at %d", x1, x2, y);
+		if (x2 < x1 || x1 < 0 || x2 >= viewwidth || y > viewheight)
+			I_Error("R_MapPlane: %d, %d at %d", x1, x2, y);
 #endif
 
-	if (x1 >= vid.width)
-		x1 = vid.width - 1;
+		if (x1 >= vid.width)
+			x1 = vid.width - 1;
+
+		ds_xfrac = xfrac + (x1 - centerx) * ds_xstep;
+		ds_yfrac = yfrac + (x1 - centerx) * ds_ystep;
+		ds_x1 = x1;
+		ds_x2 = x2;
+
+		spanfunc();
+	}
+}
 
+static void R_MapTiltedPlane(INT32 y, INT32 span)
+{
 	// Water ripple effect
 	if (planeripple.active)
 	{
@@ -256,25 +338,32 @@ static void R_MapTiltedPlane(INT32 y, INT32 x1, INT32 x2)
 		ds_colormap = colormaps;
 
 	ds_y = y;
-	ds_x1 = x1;
-	ds_x2 = x2;
 
-	spanfunc();
+	for (; span != -1; span = planespans[span].next)
+	{
+		INT32 x1 = planespans[span].x1;
+		INT32 x2 = planespans[span].x2;
+
+#ifdef RANGECHECK
+		if (x2 < x1 || x1 < 0 || x2 >= viewwidth || y > viewheight)
+			I_Error("R_MapTiltedPlane: %d, %d at %d", x1, x2, y);
+#endif
+
+		if (x1 >= vid.width)
+			x1 = vid.width - 1;
+
+		ds_x1 = x1;
+		ds_x2 = x2;
+
+		spanfunc();
+	}
 }
 
-static void R_MapFogPlane(INT32 y, INT32 x1, INT32 x2)
+static void R_MapFogPlane(INT32 y, INT32 span)
 {
 	fixed_t distance;
 	size_t pindex;
 
-#ifdef RANGECHECK
-	if (x2 < x1 || x1 < 0 || x2 >= viewwidth || y > viewheight)
-		I_Error("R_MapFogPlane: %d, %d at %d", x1, x2, y);
-#endif
-
-	if (x1 >= vid.width)
-		x1 = vid.width - 1;
-
 	if (planeheight != cachedheight[y])
 		distance = FixedMul(planeheight, yslope[y]);
 	else
@@ -289,32 +378,54 @@ static void R_MapFogPlane(INT32 y, INT32 x1, INT32 x2)
 		ds_colormap = currentplane->extra_colormap->colormap + (ds_colormap - colormaps);
 
 	ds_y = y;
-	ds_x1 = x1;
-	ds_x2 = x2;
 
-	spanfunc();
-}
+	for (; span != -1; span = planespans[span].next)
+	{
+		INT32 x1 = planespans[span].x1;
+		INT32 x2 = planespans[span].x2;
 
-static void R_MapTiltedFogPlane(INT32 y, INT32 x1, INT32 x2)
-{
 #ifdef RANGECHECK
-	if (x2 < x1 || x1 < 0 || x2 >= viewwidth || y > viewheight)
-		I_Error("R_MapTiltedFogPlane: %d, %d at %d", x1, x2, y);
+		if (x2 < x1 || x1 < 0 || x2 >= viewwidth || y > viewheight)
+			I_Error("R_MapFogPlane: %d, %d at %d", x1, x2, y);
 #endif
 
-	if (x1 >= vid.width)
-		x1 = vid.width - 1;
+		if (x1 >= vid.width)
+			x1 = vid.width - 1;
 
+		ds_x1 = x1;
+		ds_x2 = x2;
+
+		spanfunc();
+	}
+}
+
+static void R_MapTiltedFogPlane(INT32 y, INT32 span)
+{
 	if (currentplane->extra_colormap)
 		ds_colormap = currentplane->extra_colormap->colormap;
 	else
 		ds_colormap = colormaps;
 
 	ds_y = y;
-	ds_x1 = x1;
-	ds_x2 = x2;
 
-	spanfunc();
+	for (; span != -1; span = planespans[span].next)
+	{
+		INT32 x1 = planespans[span].x1;
+		INT32 x2 = planespans[span].x2;
+
+#ifdef RANGECHECK
+		if (x2 < x1 || x1 < 0 || x2 >= viewwidth || y > viewheight)
+			I_Error("R_MapTiltedFogPlane: %d, %d at %d", x1, x2, y);
+#endif
+
+		if (x1 >= vid.width)
+			x1 = vid.width - 1;
+
+		ds_x1 = x1;
+		ds_x2 = x2;
+
+		spanfunc();
+	}
 }
 
 void R_ClearFFloorClips (void)
@@ -334,6 +445,38 @@ void R_ClearFFloorClips (void)
 	numffloors = 0;
 }
 
+//
+// R_ResizeVisplaneHash
+// Grows the hash when the last frame had more planes than buckets, and
+// shrinks it once they'd fit in a quarter of it, so it doesn't flip-flop.
+// The lists must be empty.
+//
+static void R_ResizeVisplaneHash(void)
+{
+	UINT32 size = visplanehashmask + 1;
+
+	if (!visplanes)
+		size = 1<<MINVISPLANEHASHBITS;
+
+	while (size < (UINT32)visplanescreated && size < 1<<MAXVISPLANEHASHBITS)
+		size <<= 1;
+	while (size > 1<<MINVISPLANEHASHBITS && (UINT32)visplanescreated < size/4)
+		size >>= 1;
+
+	if (!visplanes || size != visplanehashmask + 1)
+	{
+		visplanes = Z_Realloc(visplanes, (size + 1) * sizeof (*visplanes), PU_STATIC, NULL);
+		memset(visplanes, 0, (size + 1) * sizeof (*visplanes));
+		visplanehashmask = size - 1;
+		numvisplanelists = size + 1;
+	}
+
+	visplanescreated = 0;
+	ps_numvisplanes.value.i = 0;
+	ps_visplanemerges.value.i = 0;
+	ps_visplanechain.value.i = 0;
+}
+
 //
 // R_ClearPlanes
 // At begining of frame.
@@ -355,13 +498,15 @@ void R_ClearPlanes(void)
 		}
 	}
 
-	for (i = 0; i < MAXVISPLANES; i++)
+	for (i = 0; i < numvisplanelists; i++)
 	for (*freehead = visplanes[i], visplanes[i] = NULL;
 		freehead && *freehead ;)
 	{
 		freehead = &(*freehead)->next;
 	}
 
+	R_ResizeVisplaneHash();
+
 	// texture calculation
 	memset(cachedheight, 0, sizeof (cachedheight));
 }
@@ -380,6 +525,7 @@ static visplane_t *new_visplane(unsigned hash)
 		if (!freetail)
 			freehead = &freetail;
 	}
+	ps_numvisplanes.value.i = ++visplanescreated;
 	check->next = visplanes[hash];
 	visplanes[hash] = check;
 	return check;
@@ -396,6 +542,7 @@ visplane_t *R_FindPlane(fixed_t height, INT32 picnum, INT32 lightlevel,
 {
 	visplane_t *check;
 	unsigned hash;
+	INT32 chain = 0;
 
 	if (!slope) // Don't mess with this right now if a slope is involved
 	{
@@ -438,9 +585,11 @@ visplane_t *R_FindPlane(fixed_t height, INT32 picnum, INT32 lightlevel,
 
 	if (!pfloor)
 	{
-		hash = visplane_hash(picnum, lightlevel, height);
+		hash = visplane_hash(height, picnum, lightlevel, xoff, yoff, plangle, planecolormap, slope, polyobj);
 		for (check = visplanes[hash]; check; check = check->next)
 		{
+			if (++chain > ps_visplanechain.value.i)
+				ps_visplanechain.value.i = chain;
 			if (polyobj != check->polyobj)
 				continue;
 			if (height == check->height && picnum == check->picnum
@@ -452,13 +601,14 @@ visplane_t *R_FindPlane(fixed_t height, INT32 picnum, INT32 lightlevel,
 				&& check->plangle == plangle
 				&& check->slope == slope)
 			{
+				ps_visplanemerges.value.i++;
 				return check;
 			}
 		}
 	}
 	else
 	{
-		hash = MAXVISPLANES - 1;
+		hash = numvisplanelists - 1;
 	}
 
 	check = new_visplane(hash);
@@ -524,6 +674,7 @@ visplane_t *R_CheckPlane(visplane_t *pl, INT32 start, INT32 stop)
 
 	if (x > intrh) /* Can use existing plane; extend range */
 	{
+		ps_visplanemerges.value.i++;
 		pl->minx = unionl;
 		pl->maxx = unionh;
 	}
@@ -532,12 +683,12 @@ visplane_t *R_CheckPlane(visplane_t *pl, INT32 start, INT32 stop)
 		visplane_t *new_pl;
 		if (pl->ffloor)
 		{
-			new_pl = new_visplane(MAXVISPLANES - 1);
+			new_pl = new_visplane(numvisplanelists - 1);
 		}
 		else
 		{
-			unsigned hash =
-				visplane_hash(pl->picnum, pl->lightlevel, pl->height);
+			unsigned hash = visplane_hash(pl->height, pl->picnum, pl->lightlevel,
+				pl->xoffs, pl->yoffs, pl->plangle, pl->extra_colormap, pl->slope, pl->polyobj);
 			new_pl = new_visplane(hash);
 		}
 
@@ -583,7 +734,37 @@ void R_ExpandPlane(visplane_t *pl, INT32 start, INT32 stop)
 	if (pl->maxx < stop)  pl->maxx = stop;
 }
 
-static void R_MakeSpans(void (*mapfunc)(INT32, INT32, INT32), INT32 x, INT32 t1, INT32 b1, INT32 t2, INT32 b2)
+static void R_AddPlaneSpan(INT32 y, INT32 x1, INT32 x2)
+{
+	if (numplanespans == maxplanespans)
+	{
+		maxplanespans = maxplanespans ? maxplanespans * 2 : 4096;
+		planespans = Z_Realloc(planespans, maxplanespans * sizeof (*planespans), PU_STATIC, NULL);
+	}
+
+	if (planespantop > planespanbottom)
+	{
+		planespantop = planespanbottom = y;
+		planespanrows[y] = -1;
+	}
+	else if (y < planespantop)
+	{
+		while (planespantop > y)
+			planespanrows[--planespantop] = -1;
+	}
+	else if (y > planespanbottom)
+	{
+		while (planespanbottom < y)
+			planespanrows[++planespanbottom] = -1;
+	}
+
+	planespans[numplanespans].x1 = x1;
+	planespans[numplanespans].x2 = x2;
+	planespans[numplanespans].next = planespanrows[y];
+	planespanrows[y] = numplanespans++;
+}
+
+static void R_MakeSpans(INT32 x, INT32 t1, INT32 b1, INT32 t2, INT32 b2)
 {
 	//    Alam: from r_splats's R_RasterizeFloorSplat
 	if (t1 >= vid.height) t1 = vid.height-1;
@@ -594,12 +775,12 @@ static void R_MakeSpans(void (*mapfunc)(INT32, INT32, INT32), INT32 x, INT32 t1,
 
 	while (t1 < t2 && t1 <= b1)
 	{
-		mapfunc(t1, spanstart[t1], x - 1);
+		R_AddPlaneSpan(t1, spanstart[t1], x - 1);
 		t1++;
 	}
 	while (b1 > b2 && b1 >= t1)
 	{
-		mapfunc(b1, spanstart[b1], x - 1);
+		R_AddPlaneSpan(b1, spanstart[b1], x - 1);
 		b1--;
 	}
 
@@ -609,25 +790,84 @@ static void R_MakeSpans(void (*mapfunc)(INT32, INT32, INT32), INT32 x, INT32 t1,
 		spanstart[b2--] = x;
 }
 
+// Collects the spans covering a plane's columns.
+static void R_MakePlaneSpans(visplane_t *pl)
+{
+	INT32 x, stop;
+
+	// set the maximum value for unsigned
+	pl->top[pl->maxx+1] = 0xffff;
+	pl->top[pl->minx-1] = 0xffff;
+	pl->bottom[pl->maxx+1] = 0x0000;
+	pl->bottom[pl->minx-1] = 0x0000;
+
+	stop = pl->maxx + 1;
+
+	for (x = pl->minx; x <= stop; x++)
+		R_MakeSpans(x, pl->top[x-1], pl->bottom[x-1], pl->top[x], pl->bottom[x]);
+}
+
+// Draws and empties the span buffer, one row at a time.
+static void R_DrawPlaneSpans(planemapfunc_t mapfunc)
+{
+	INT32 y;
+
+	for (y = planespantop; y <= planespanbottom; y++)
+	{
+		if (planespanrows[y] != -1)
+			mapfunc(y, planespanrows[y]);
+	}
+
+	numplanespans = 0;
+	planespantop = INT32_MAX;
+	planespanbottom = -1;
+}
+
+// Can b's spans be drawn in the same pass as a's?
+// Only planes that R_FindPlane would have merged, if not for their
+// columns overlapping, are drawn together.
+static boolean R_CanBatchPlanes(visplane_t *a, visplane_t *b)
+{
+	return a->minx <= a->maxx && b->minx <= b->maxx
+		&& !a->ffloor && !a->polyobj && !b->ffloor && !b->polyobj
+		&& a->picnum == b->picnum && a->picnum != skyflatnum
+		&& a->height == b->height && a->lightlevel == b->lightlevel
+		&& a->xoffs == b->xoffs && a->yoffs == b->yoffs
+		&& a->extra_colormap == b->extra_colormap
+		&& a->viewx == b->viewx && a->viewy == b->viewy && a->viewz == b->viewz
+		&& a->viewangle == b->viewangle && a->plangle == b->plangle
+		&& a->slope == b->slope;
+}
+
+static void R_DrawPlane(visplane_t *pl, boolean batch);
+
 void R_DrawPlanes(void)
 {
-	visplane_t *pl;
+	visplane_t *pl, *check;
 	INT32 i;
 
 	R_UpdatePlaneRipple();
 
-	for (i = 0; i < MAXVISPLANES; i++, pl++)
+	for (i = 0; i < numvisplanelists; i++)
 	{
 		for (pl = visplanes[i]; pl; pl = pl->next)
 		{
 			if (pl->ffloor != NULL || pl->polyobj != NULL)
 				continue;
 
-			R_DrawSinglePlane(pl);
+			// Already drawn along with an earlier plane in this list?
+			for (check = visplanes[i]; check != pl; check = check->next)
+				if (R_CanBatchPlanes(check, pl))
+					break;
+			if (check != pl)
+				continue;
+
+			R_DrawPlane(pl, true);
 		}
 	}
 }
 
+//
 // R_DrawSkyPlane
 //
 // Draws the sky within the plane's top/bottom bounds
@@ -845,14 +1085,16 @@ static inline void R_AdjustSlopeCoordinatesNPO2(vector3_t *origin)
 	yoffs += (origin->y + oy);
 }
 
-void R_DrawSinglePlane(visplane_t *pl)
+// Draws a plane, and if batch is set, every plane after it in its
+// list that R_CanBatchPlanes allows to be drawn in the same pass.
+static void R_DrawPlane(visplane_t *pl, boolean batch)
 {
 	INT32 light = 0;
-	INT32 x, stop;
+	INT32 x;
 	ffloor_t *rover;
 	boolean fog = false;
 	INT32 spanfunctype = BASEDRAWFUNC;
-	void (*mapfunc)(INT32, INT32, INT32);
+	planemapfunc_t mapfunc;
 
 	if (!(pl->minx <= pl->maxx))
 		return;
@@ -1104,6 +1346,18 @@ void R_DrawSinglePlane(visplane_t *pl)
 		planezlight = zlight[light];
 	}
 
+	// Mipmaps only for flat, opaque planes
+	planemip.active = (cv_mipmap.value && ds_powersoftwo && !pl->slope
+		&& spanfunctype != SPANDRAWFUNC_SPLAT && spanfunctype != SPANDRAWFUNC_TRANSSPLAT);
+	if (planemip.active)
+	{
+		planemip.levelflat = &levelflats[pl->picnum];
+		planemip.source = ds_source;
+		planemip.size = ds_flatwidth;
+		planemip.level = 0;
+		planemip.maxlevel = MAXMIPLEVELS;
+	}
+
 	// Set the span drawer
 	if (!ds_powersoftwo)
 	{
@@ -1115,17 +1369,24 @@ void R_DrawSinglePlane(visplane_t *pl)
 	else
 		spanfunc = spanfuncs[spanfunctype];
 
-	// set the maximum value for unsigned
-	pl->top[pl->maxx+1] = 0xffff;
-	pl->top[pl->minx-1] = 0xffff;
-	pl->bottom[pl->maxx+1] = 0x0000;
-	pl->bottom[pl->minx-1] = 0x0000;
-
 	currentplane = pl;
-	stop = pl->maxx + 1;
+	R_MakePlaneSpans(pl);
 
-	for (x = pl->minx; x <= stop; x++)
-		R_MakeSpans(mapfunc, x, pl->top[x-1], pl->bottom[x-1], pl->top[x], pl->bottom[x]);
+	if (batch)
+	{
+		visplane_t *check;
+
+		for (check = pl->next; check; check = check->next)
+			if (R_CanBatchPlanes(pl, check))
+				R_MakePlaneSpans(check);
+	}
+
+	R_DrawPlaneSpans(mapfunc);
+}
+
+void R_DrawSinglePlane(visplane_t *pl)
+{
+	R_DrawPlane(pl, false);
 }
 
 void R_PlaneBounds(visplane_t *plane)
@@ -1018,6 +1018,23 @@ static boolean R_FFloorCanClip(visffloor_t *pfloor)
 	return (cv_ffloorclip.value && !R_IsFFloorTranslucent(pfloor) && !pfloor->polyobj);
 }
 
+//
+// R_SetWallColumn
+// Points the column drawer at a column of a wall texture, or of its
+//  mipmap when a level other than 0 is asked for.
+//
+static void R_SetWallColumn(INT32 tex, INT32 col, fixed_t texturemid, INT32 level, fixed_t iscale)
+{
+	if (level)
+		dc_source = R_GetColumnMip(tex, col, &level);
+	else
+		dc_source = R_GetColumn(tex, col);
+
+	dc_texturemid = texturemid >> level;
+	dc_texheight = (textureheight[tex]>>FRACBITS) >> level;
+	dc_iscale = iscale >> level;
+}
+
 //
 // R_RenderSegLoop
 // Draws zero, one, or two textures (and possibly a masked
@@ -1054,6 +1071,8 @@ static void R_RenderSegLoop (void)
 	INT32     top;
 	INT32     bottom;
 	INT32     i;
+	INT32     wallmiplevel = 0;
+	fixed_t   walliscale = 0;
 
 	for (; rw_x < rw_stopx; rw_x++)
 	{
@@ -1241,6 +1260,8 @@ static void R_RenderSegLoop (void)
 			dc_colormap = walllights[pindex];
 			dc_x = rw_x;
 			dc_iscale = 0xffffffffu / (unsigned)rw_scale;
+			walliscale = dc_iscale;
+			wallmiplevel = cv_mipmap.value ? R_MipLevelForStep((UINT32)dc_iscale) : 0;
 
 			if (frontsector->extra_colormap)
 				dc_colormap = frontsector->extra_colormap->colormap + (dc_colormap - colormaps);
@@ -1292,9 +1313,7 @@ static void R_RenderSegLoop (void)
 			{
 				dc_yl = yl;
 				dc_yh = yh;
-				dc_texturemid = rw_midtexturemid;
-				dc_source = R_GetColumn(midtexture, itexturecolumn + (rw_offset_mid>>FRACBITS));
-				dc_texheight = textureheight[midtexture]>>FRACBITS;
+				R_SetWallColumn(midtexture, itexturecolumn + (rw_offset_mid>>FRACBITS), rw_midtexturemid, wallmiplevel, walliscale);
 
 				//profile stuff ---------------------------------------------------------
 #ifdef TIMING
@@ -1353,9 +1372,7 @@ static void R_RenderSegLoop (void)
 					{
 						dc_yl = yl;
 						dc_yh = mid;
-						dc_texturemid = rw_toptexturemid;
-						dc_source = R_GetColumn(toptexture, itexturecolumn + (rw_offset_top>>FRACBITS));
-						dc_texheight = textureheight[toptexture]>>FRACBITS;
+						R_SetWallColumn(toptexture, itexturecolumn + (rw_offset_top>>FRACBITS), rw_toptexturemid, wallmiplevel, walliscale);
 						colfunc();
 						ceilingclip[rw_x] = (INT16)mid;
 					}
@@ -1389,9 +1406,7 @@ static void R_RenderSegLoop (void)
 					{
 						dc_yl = mid;
 						dc_yh = yh;
-						dc_texturemid = rw_bottomtexturemid;
-						dc_source = R_GetColumn(bottomtexture, itexturecolumn + (rw_offset_bot>>FRACBITS));
-						dc_texheight = textureheight[bottomtexture]>>FRACBITS;
+						R_SetWallColumn(bottomtexture, itexturecolumn + (rw_offset_bot>>FRACBITS), rw_bottomtexturemid, wallmiplevel, walliscale);
 						colfunc();
 						floorclip[rw_x] = (INT16)mid;
 					}
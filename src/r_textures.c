@@ -27,6 +27,7 @@
 #include "p_setup.h" // levelflats
 #include "byteptr.h"
 #include "dehacked.h"
+#include "v_video.h" // InitColorLUT
 
 #ifdef HWRENDER
 #include "hardware/hw_glob.h" // HWR_LoadMapTextures
@@ -56,6 +57,24 @@ fixed_t *textureheight; // needed for texture pegging
 
 INT32 *texturetranslation;
 
+static size_t texturecachememory; // bytes of generated textures currently in texturecache
+
+// Mipmaps of flats, keyed by lump or texture number
+typedef struct flatmips_s
+{
+	UINT8 type; // LEVELFLAT_FLAT or LEVELFLAT_TEXTURE
+	UINT32 num;
+	UINT8 *mipmaps;
+	UINT8 miplevels;
+	size_t size; // of mipmaps, counted in texturecachememory
+	size_t lastused; // framecount when the mipmaps were last drawn
+	struct flatmips_s *next;
+} flatmips_t;
+
+#define FLATMIPHASHSIZE 256
+static flatmips_t *flatmiphash[FLATMIPHASHSIZE];
+static colorlookup_t mip_colorlookup;
+
 // Painfully simple texture id cacheing to make maps load faster. :3
 static struct {
 	char name[9];
@@ -278,6 +297,10 @@ UINT8 *R_GenerateTexture(size_t texnum)
 	texture = textures[texnum];
 	I_Assert(texture != NULL);
 
+	// The zone may have purged the previous block, which is still counted.
+	texturecachememory -= min(texture->cachesize, texturecachememory);
+	texture->cachesize = 0;
+
 	// allocate texture column offset lookup
 
 	// single-patch textures can have holes in them and may be used on
@@ -333,6 +356,7 @@ UINT8 *R_GenerateTexture(size_t texnum)
 			texture->holes = true;
 			texture->flip = patch->flip;
 			blocksize = lumplength;
+			texture->cachesize = blocksize;
 			block = Z_Calloc(blocksize, PU_STATIC, // will change tag at end of this function
 				&texturecache[texnum]);
 			M_Memcpy(block, realpatch, blocksize);
@@ -364,6 +388,7 @@ UINT8 *R_GenerateTexture(size_t texnum)
 	texture->flip = 0;
 	blocksize = (texture->width * 4) + (texture->width * texture->height);
 	texturememory += blocksize;
+	texture->cachesize = blocksize+1;
 	block = Z_Malloc(blocksize+1, PU_STATIC, &texturecache[texnum]);
 
 	memset(block, TRANSPARENTPIXEL, blocksize+1); // Transparency hack
@@ -456,6 +481,9 @@ UINT8 *R_GenerateTexture(size_t texnum)
 	}
 
 done:
+	texturecachememory += texture->cachesize;
+	texture->lastused = framecount;
+
 	// Now that the texture has been built in column cache, it is purgable from zone memory.
 	Z_ChangeTag(block, PU_CACHE);
 	return blocktex;
@@ -530,6 +558,8 @@ UINT8 *R_GetColumn(fixed_t tex, INT32 col)
 	if (!data)
 		data = R_GenerateTexture(tex);
 
+	textures[tex]->lastused = framecount;
+
 	return data + LONG(texturecolumnofs[tex][col]);
 }
 
@@ -538,6 +568,220 @@ void *R_GetFlat(lumpnum_t flatlumpnum)
 	return W_CacheLumpNum(flatlumpnum, PU_CACHE);
 }
 
+//
+// MIPMAPS
+// Downsampled copies of textures and flats, so that surfaces far away don't
+//  skip over most of their texels and shimmer. Every level is half the size
+//  of the previous one, filtered 2x2 in RGB and matched back to the palette.
+// The image is stored as a number of lines (columns for textures, rows for
+//  flats) of the same length, and so are all the levels, one after another.
+//
+
+static size_t R_MipOffset(INT32 count, INT32 length, INT32 level)
+{
+	size_t offset = 0;
+	INT32 i;
+
+	for (i = 1; i < level; i++)
+		offset += (size_t)(count >> i) * (length >> i);
+
+	return offset;
+}
+
+// Takes a texture's mipmaps out of texturecachememory, whether they were
+// just freed or purged by the zone. miplevels is all that is left to go by.
+static void R_UncountMips(INT32 tex)
+{
+	texture_t *texture = textures[tex];
+
+	if (texture->miplevels)
+	{
+		size_t size = R_MipOffset(texturewidth[tex], texture->height, texture->miplevels + 1);
+		texturecachememory -= min(size, texturecachememory);
+	}
+	texture->miplevels = 0;
+}
+
+static void R_DownsampleMip(const UINT8 *src, UINT8 *dest, INT32 count, INT32 length)
+{
+	INT32 x, y;
+
+	for (y = 0; y < count; y += 2)
+	{
+		const UINT8 *a = src + (y * length);
+		const UINT8 *b = a + length;
+
+		for (x = 0; x < length; x += 2)
+		{
+			RGBA_t p1 = pMasterPalette[a[x]], p2 = pMasterPalette[a[x+1]];
+			RGBA_t p3 = pMasterPalette[b[x]], p4 = pMasterPalette[b[x+1]];
+
+			*dest++ = GetColorLUT(&mip_colorlookup,
+				(p1.s.red + p2.s.red + p3.s.red + p4.s.red + 2) >> 2,
+				(p1.s.green + p2.s.green + p3.s.green + p4.s.green + 2) >> 2,
+				(p1.s.blue + p2.s.blue + p3.s.blue + p4.s.blue + 2) >> 2);
+		}
+	}
+}
+
+//
+// R_GenerateMips
+//
+// Builds as many mip levels of an image as its size allows, in a single block.
+// The smallest level is kept at least 2x2, as the span drawer can't take 1x1
+// flats. Returns NULL if the image can't be halved that far.
+//
+static UINT8 *R_GenerateMips(const UINT8 *src, INT32 count, INT32 length, UINT8 *levels, size_t *size, void **user)
+{
+	UINT8 *block, *dest;
+	INT32 i, numlevels = 0;
+
+	while (numlevels < MAXMIPLEVELS && (count >> (numlevels+1)) >= 2 && (length >> (numlevels+1)) >= 2
+		&& !((count >> numlevels) & 1) && !((length >> numlevels) & 1))
+		numlevels++;
+
+	*levels = (UINT8)numlevels;
+	*size = 0;
+	if (!numlevels)
+		return NULL;
+
+	*size = R_MipOffset(count, length, numlevels + 1);
+	block = Z_Malloc(*size, PU_STATIC, user);
+
+	InitColorLUT(&mip_colorlookup, pMasterPalette, false);
+
+	for (i = 1, dest = block; i <= numlevels; i++)
+	{
+		R_DownsampleMip(src, dest, count >> (i-1), length >> (i-1));
+		src = dest;
+		dest += (size_t)(count >> i) * (length >> i);
+	}
+
+	return block;
+}
+
+//
+// R_MipLevelForStep
+//
+// Picks the mip level for a surface that advances step texels per pixel.
+//
+INT32 R_MipLevelForStep(UINT32 step)
+{
+	INT32 level = 0;
+
+	while (level < MAXMIPLEVELS && step >= (UINT32)(2*FRACUNIT))
+	{
+		step >>= 1;
+		level++;
+	}
+
+	return level;
+}
+
+//
+// R_GetColumnMip
+//
+// Like R_GetColumn, but from the given mip level of the texture.
+// level is lowered to the smallest level the texture actually has, which is
+// 0 for textures with holes or odd sizes.
+//
+UINT8 *R_GetColumnMip(fixed_t tex, INT32 col, INT32 *level)
+{
+	texture_t *texture = textures[tex];
+	INT32 width = texturewidth[tex];
+
+	if (!texture->mipmaps && !texture->nomips)
+	{
+		size_t size;
+
+		R_UncountMips(tex); // purged ones are still counted
+
+		if (!texturecache[tex])
+			R_GenerateTexture(tex);
+
+		if (texture->holes)
+			texture->nomips = true;
+		else
+		{
+			R_GenerateMips(texturecache[tex] + (width*4), width, texture->height, &texture->miplevels, &size, (void **)&texture->mipmaps);
+			if (texture->mipmaps)
+			{
+				Z_ChangeTag(texture->mipmaps, PU_CACHE);
+				texturecachememory += size;
+			}
+			else
+				texture->nomips = true;
+		}
+	}
+
+	if (*level > texture->miplevels)
+		*level = texture->miplevels;
+
+	if (!*level || !texture->mipmaps)
+	{
+		*level = 0;
+		return R_GetColumn(tex, col);
+	}
+
+	if (width & (width - 1))
+		col = (UINT32)col % width;
+	else
+		col &= (width - 1);
+
+	texture->lastused = framecount;
+
+	return texture->mipmaps + R_MipOffset(width, texture->height, *level)
+		+ (col >> *level) * (texture->height >> *level);
+}
+
+//
+// R_GetFlatMip
+//
+// Returns the given mip level of a square flat, which is size pixels wide.
+// level is lowered to the smallest level the flat actually has.
+//
+UINT8 *R_GetFlatMip(levelflat_t *levelflat, UINT8 *flat, INT32 size, INT32 *level)
+{
+	flatmips_t *mips;
+	UINT32 num;
+
+	if (levelflat->type == LEVELFLAT_FLAT)
+		num = levelflat->u.flat.lumpnum;
+	else if (levelflat->type == LEVELFLAT_TEXTURE)
+		num = levelflat->u.texture.num;
+	else
+	{
+		*level = 0;
+		return flat;
+	}
+
+	for (mips = flatmiphash[num % FLATMIPHASHSIZE]; mips; mips = mips->next)
+		if (mips->type == levelflat->type && mips->num == num)
+			break;
+
+	if (!mips)
+	{
+		mips = Z_Calloc(sizeof (*mips), PU_STATIC, NULL);
+		mips->type = levelflat->type;
+		mips->num = num;
+		mips->next = flatmiphash[num % FLATMIPHASHSIZE];
+		flatmiphash[num % FLATMIPHASHSIZE] = mips;
+
+		R_GenerateMips(flat, size, size, &mips->miplevels, &mips->size, (void **)&mips->mipmaps);
+		texturecachememory += mips->size;
+	}
+
+	mips->lastused = framecount;
+
+	if (*level > mips->miplevels)
+		*level = mips->miplevels;
+
+	if (!*level)
+		return flat;
+
+	return mips->mipmaps + R_MipOffset(size, size, *level);
+}
+
 //
 // R_GetLevelFlat
 //
@@ -713,6 +957,35 @@ void R_SetFlatVars(size_t length)
 	nflatmask = (size - 1) * size;
 }
 
+//
+// R_FreeFlatMips
+//
+// Frees the mipmaps of flats, or only those not drawn this frame if unused.
+//
+static void R_FreeFlatMips(boolean unused)
+{
+	flatmips_t **link, *mips;
+	INT32 i;
+
+	for (i = 0; i < FLATMIPHASHSIZE; i++)
+	{
+		link = &flatmiphash[i];
+		while ((mips = *link) != NULL)
+		{
+			if (unused && mips->lastused == framecount)
+			{
+				link = &mips->next;
+				continue;
+			}
+
+			*link = mips->next;
+			texturecachememory -= min(mips->size, texturecachememory);
+			Z_Free(mips->mipmaps);
+			Z_Free(mips);
+		}
+	}
+}
+
 //
 // Empty the texture cache (used for load wad at runtime)
 //
@@ -722,7 +995,104 @@ void R_FlushTextureCache(void)
 
 	if (numtextures)
 		for (i = 0; i < numtextures; i++)
+		{
 			Z_Free(texturecache[i]);
+			Z_Free(textures[i]->mipmaps);
+			textures[i]->cachesize = 0;
+			textures[i]->miplevels = 0;
+			textures[i]->nomips = false;
+		}
+
+	texturecachememory = 0;
+
+	R_FreeFlatMips(false);
+}
+
+//
+// R_FlushMips
+//
+// Frees every mipmap, so they get built again from the current palette.
+//
+void R_FlushMips(void)
+{
+	INT32 i;
+
+	for (i = 0; i < numtextures; i++)
+	{
+		R_UncountMips(i);
+		Z_Free(textures[i]->mipmaps);
+		textures[i]->nomips = false;
+	}
+
+	R_FreeFlatMips(false);
+}
+
+static int R_CompareTextureLastUse(const void *a, const void *b)
+{
+	size_t ua = textures[*(const INT32 *)a]->lastused;
+	size_t ub = textures[*(const INT32 *)b]->lastused;
+	return (ua > ub) - (ua < ub);
+}
+
+//
+// R_TrimTextureCache
+//
+// Generated textures are kept until the texture cache is flushed, so a long
+// session through many levels keeps piling them up. When cv_texturecache sets
+// a budget and it's exceeded, the least recently used textures are freed,
+// down to a bit under the budget so this doesn't have to run every frame,
+// followed by the mipmaps of flats that weren't drawn last frame.
+// Call at the start of a frame, while no columns are being held on to.
+//
+void R_TrimTextureCache(void)
+{
+	size_t budget = (size_t)cv_texturecache.value << 20;
+	INT32 *lru, numlru = 0;
+	INT32 i, freed = 0;
+
+	if (!budget || texturecachememory <= budget)
+		return;
+
+	lru = malloc(numtextures * sizeof (*lru));
+	if (!lru)
+		return;
+
+	for (i = 0; i < numtextures; i++)
+	{
+		// Blocks the zone purged are still counted
+		if (!texturecache[i])
+		{
+			texturecachememory -= min(textures[i]->cachesize, texturecachememory);
+			textures[i]->cachesize = 0;
+		}
+		if (!textures[i]->mipmaps)
+			R_UncountMips(i);
+
+		if ((texturecache[i] || textures[i]->mipmaps) && textures[i]->lastused != framecount)
+			lru[numlru++] = i;
+	}
+
+	qsort(lru, numlru, sizeof (*lru), R_CompareTextureLastUse);
+
+	budget -= budget >> 3;
+	for (i = 0; i < numlru && texturecachememory > budget; i++)
+	{
+		texture_t *texture = textures[lru[i]];
+
+		Z_Free(texturecache[lru[i]]);
+		Z_Free(texture->mipmaps);
+		R_UncountMips(lru[i]);
+		texturecachememory -= min(texture->cachesize, texturecachememory);
+		texture->cachesize = 0;
+		freed++;
+	}
+
+	free(lru);
+
+	if (texturecachememory > budget)
+		R_FreeFlatMips(true);
+
+	CONS_Debug(DBG_RENDER, "R_TrimTextureCache: freed %d textures, %s KB still cached\n", freed, sizeu1(texturecachememory>>10));
 }
 
 // Need these prototypes for later; defining them here instead of r_textures.h so they're "private"
@@ -36,6 +36,9 @@ typedef struct
 	enum patchalphastyle style;
 } texpatch_t;
 
+// Smallest mip level is 1/(1<<MAXMIPLEVELS) of the original size
+#define MAXMIPLEVELS 4
+
 // texture type
 enum
 {
@@ -60,6 +63,11 @@ typedef struct
 	boolean holes;
 	UINT8 flip; // 1 = flipx, 2 = flipy, 3 = both
 	void *flat; // The texture, as a flat.
+	size_t cachesize; // Size of the generated texture in texturecache, 0 if there isn't one.
+	size_t lastused; // framecount when a column was last fetched from it.
+	UINT8 *mipmaps; // Downsampled copies of the generated texture, smallest last.
+	UINT8 miplevels; // Number of levels in mipmaps.
+	boolean nomips; // Set once the texture turned out unable to have mipmaps.
 
 	// All the patches[patchcount] are drawn back to front into the cached texture.
 	INT16 patchcount;
@@ -79,6 +87,7 @@ extern UINT8 **texturecache; // graphics data for each generated full-size textu
 void R_LoadTextures(void);
 void R_LoadTexturesPwad(UINT16 wadnum);
 void R_FlushTextureCache(void);
+void R_TrimTextureCache(void);
 
 // Texture generation
 UINT8 *R_GenerateTexture(size_t texnum);
@@ -92,6 +101,12 @@ void *R_GetLevelFlat(levelflat_t *levelflat);
 UINT8 *R_GetColumn(fixed_t tex, INT32 col);
 void *R_GetFlat(lumpnum_t flatnum);
 
+// Mipmaps for the software renderer.
+INT32 R_MipLevelForStep(UINT32 step);
+UINT8 *R_GetColumnMip(fixed_t tex, INT32 col, INT32 *level);
+UINT8 *R_GetFlatMip(levelflat_t *levelflat, UINT8 *flat, INT32 size, INT32 *level);
+void R_FlushMips(void);
+
 boolean R_CheckPowersOfTwo(void);
 boolean R_CheckSolidColorFlat(void);
 
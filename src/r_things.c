@@ -1565,7 +1565,7 @@ static void R_ProjectBoundingBox(mobj_t *thing, vissprite_t *vis)
 // Generates a vissprite for a thing
 // if it might be visible.
 //
-static void R_ProjectSprite(mobj_t *thing)
+static void R_ProjectSprite(mobj_t *thing, const interpmobjstate_t *thinginterp)
 {
 	mobj_t *oldthing = thing;
 	fixed_t tr_x, tr_y;
@@ -1633,18 +1633,8 @@ static void R_ProjectSprite(mobj_t *thing)
 	angle_t spriterotangle = 0;
 #endif
 
-	// uncapped/interpolation
-	interpmobjstate_t interp = {0};
-
-	// do interpolation
-	if (R_UsingFrameInterpolation() && !paused)
-	{
-		R_InterpolateMobjState(oldthing, rendertimefrac, &interp);
-	}
-	else
-	{
-		R_InterpolateMobjState(oldthing, FRACUNIT, &interp);
-	}
+	// uncapped/interpolation, already done by R_AddSprites
+	interpmobjstate_t interp = *thinginterp;
 
 	this_scale = interp.scale;
 	radius = interp.radius; // For drop shadows
@@ -2037,6 +2027,27 @@ static void R_ProjectSprite(mobj_t *thing)
 			return;
 	}
 
+	// Hidden behind solid walls already? Checked with the thing's own column
+	// and its drop shadow included, so the walls are in front of all of it.
+	if (cv_spriteclip.value && !(papersprite || splat || (cut & SC_LINKDRAW)))
+	{
+		INT32 ox = (centerxfrac + FixedMul(basetx, xscale))>>FRACBITS;
+		INT32 ox1 = min(x1, ox), ox2 = max(x2, ox);
+
+		if (oldthing->shadowscale && cv_shadow.value)
+		{
+			fixed_t shadowradius = FixedMul(radius, oldthing->shadowscale);
+			ox1 = min(ox1, (centerxfrac + FixedMul(basetx - shadowradius, xscale))>>FRACBITS);
+			ox2 = max(ox2, (centerxfrac + FixedMul(basetx + shadowradius, xscale))>>FRACBITS);
+		}
+
+		if (R_IsRangeOccluded(ox1, ox2, sortscale))
+		{
+			ps_spritesoccluded.value.i++;
+			return;
+		}
+	}
+
 	INT32 blendmode;
 	if (oldthing->frame & FF_BLENDMASK)
 		blendmode = ((oldthing->frame & FF_BLENDMASK) >> FF_BLENDSHIFT) + 1;
@@ -2346,7 +2357,7 @@ static void R_ProjectPrecipitationSprite(precipmobj_t *thing)
 	fixed_t tx, tz;
 	fixed_t xscale, yscale; //added : 02-02-98 : aaargll..if I were a math-guy!!!
 
-	INT32 x1, x2;
+	INT32 x1, x2, ox;
 
 	spritedef_t *sprdef;
 	spriteframe_t *sprframe;
@@ -2418,6 +2429,7 @@ static void R_ProjectPrecipitationSprite(precipmobj_t *thing)
 	lump = sprframe->lumpid[0];     //Fab: see note above
 
 	// calculate edges of the shape
+	ox = (centerxfrac + FixedMul (tx,xscale)) >>FRACBITS;
 	tx -= spritecachedinfo[lump].offset;
 	x1 = (centerxfrac + FixedMul (tx,xscale)) >>FRACBITS;
 
@@ -2442,6 +2454,12 @@ static void R_ProjectPrecipitationSprite(precipmobj_t *thing)
 			return;
 	}
 
+	// Hidden behind solid walls already?
+	if (cv_spriteclip.value && R_IsRangeOccluded(min(x1, ox), max(x2, ox), yscale))
+	{
+		ps_spritesoccluded.value.i++;
+		goto weatherthink;
+	}
 
 	//SoM: 3/17/2000: Disregard sprites that are out of view..
 	gzt = interp.z + spritecachedinfo[lump].topoffset;
@@ -2518,6 +2536,61 @@ weatherthink:
 	}
 }
 
+//
+// Sprite candidates
+// R_AddSprites first gathers the things of a sector here, then culls the
+//  ones behind the view or too far off the side in a single pass over flat
+//  arrays, and only does the full projection for what's left.
+//
+static mobj_t **spritecands = NULL;
+static interpmobjstate_t *spritecandinterp = NULL;
+static fixed_t *spritecandx = NULL, *spritecandy = NULL; // relative to the view
+static fixed_t *spritecandminz = NULL;
+static UINT8 *spritecandnocull = NULL; // papersprites and splats clip themselves
+static UINT8 *spritecandvisible = NULL;
+static size_t spritecandsize = 0;
+
+static void R_GrowSpriteCandidates(size_t count)
+{
+	size_t newsize = spritecandsize ? spritecandsize : 64;
+
+	if (count <= spritecandsize)
+		return;
+
+	while (newsize < count)
+		newsize <<= 1;
+
+	spritecands = Z_Realloc(spritecands, newsize * sizeof (*spritecands), PU_STATIC, NULL);
+	spritecandinterp = Z_Realloc(spritecandinterp, newsize * sizeof (*spritecandinterp), PU_STATIC, NULL);
+	spritecandx = Z_Realloc(spritecandx, newsize * sizeof (*spritecandx), PU_STATIC, NULL);
+	spritecandy = Z_Realloc(spritecandy, newsize * sizeof (*spritecandy), PU_STATIC, NULL);
+	spritecandminz = Z_Realloc(spritecandminz, newsize * sizeof (*spritecandminz), PU_STATIC, NULL);
+	spritecandnocull = Z_Realloc(spritecandnocull, newsize * sizeof (*spritecandnocull), PU_STATIC, NULL);
+	spritecandvisible = Z_Realloc(spritecandvisible, newsize * sizeof (*spritecandvisible), PU_STATIC, NULL);
+	spritecandsize = newsize;
+}
+
+//
+// R_CullSpriteCandidates
+//
+// The same view checks R_ProjectSprite starts with, kept branch-free so the
+// compiler can vectorise them.
+//
+static void R_CullSpriteCandidates(size_t count)
+{
+	const fixed_t cosine = viewcos, sine = viewsin, tangent = fovtan;
+	size_t i;
+
+	for (i = 0; i < count; i++)
+	{
+		const fixed_t tz = FixedMul(spritecandx[i], cosine) + FixedMul(spritecandy[i], sine);
+		const fixed_t tx = FixedMul(spritecandx[i], sine) - FixedMul(spritecandy[i], cosine);
+
+		spritecandvisible[i] = (UINT8)(spritecandnocull[i]
+			| ((tz >= spritecandminz[i]) & (abs(tx) <= (FixedMul(tz, tangent)<<2))));
+	}
+}
+
 // R_AddSprites
 // During BSP traversal, this adds sprites by sector.
 //
@@ -2527,6 +2600,8 @@ void R_AddSprites(sector_t *sec, INT32 lightlevel)
 	precipmobj_t *precipthing; // Tails 08-25-2002
 	INT32 lightnum;
 	fixed_t limit_dist, hoop_limit_dist;
+	fixed_t interpfrac;
+	size_t i, numcands = 0;
 
 	if (rendermode != render_soft)
 		return;
@@ -2559,27 +2634,59 @@ void R_AddSprites(sector_t *sec, INT32 lightlevel)
 	// If a limit exists, handle things a tiny bit different.
 	limit_dist = (fixed_t)(cv_drawdist.value) << FRACBITS;
 	hoop_limit_dist = (fixed_t)(cv_drawdist_nights.value) << FRACBITS;
+	interpfrac = (R_UsingFrameInterpolation() && !paused) ? rendertimefrac : FRACUNIT;
+
 	for (thing = sec->thinglist; thing; thing = thing->snext)
 	{
-		if (R_ThingWithinDist(thing, limit_dist, hoop_limit_dist))
+		if (!R_ThingWithinDist(thing, limit_dist, hoop_limit_dist))
+			continue;
+
+		R_GrowSpriteCandidates(numcands + 1);
+		spritecands[numcands] = thing;
+		spritecandvisible[numcands] = 0;
+
+		if (R_ThingVisible(thing))
 		{
-			const INT32 oldobjectsdrawn = objectsdrawn;
+			interpmobjstate_t *interp = &spritecandinterp[numcands];
+			boolean splat = R_ThingIsFloorSprite(thing);
 
-			if (R_ThingVisible(thing))
-			{
-				R_ProjectSprite(thing);
-			}
+			R_InterpolateMobjState(thing, interpfrac, interp);
+			spritecandx[numcands] = interp->x - viewx;
+			spritecandy[numcands] = interp->y - viewy;
+			spritecandminz[numcands] = FixedMul(MINZ, interp->scale);
+			spritecandnocull[numcands] = (UINT8)(splat || R_ThingIsPaperSprite(thing));
+		}
+		else
+		{
+			// never visible, but still goes through the pass below
+			spritecandx[numcands] = spritecandy[numcands] = 0;
+			spritecandminz[numcands] = INT32_MAX;
+			spritecandnocull[numcands] = 0;
+		}
 
-			// I'm so smart :^)
-			if (objectsdrawn == oldobjectsdrawn)
-			{
-				/*
-				Object is invisible OR is off screen but
-				render its bbox even if the latter because
-				radius could be bigger than sprite.
-				*/
-				R_ProjectBoundingBox(thing, NULL);
-			}
+		numcands++;
+	}
+
+	R_CullSpriteCandidates(numcands);
+
+	for (i = 0; i < numcands; i++)
+	{
+		const INT32 oldobjectsdrawn = objectsdrawn;
+
+		if (spritecandvisible[i])
+		{
+			R_ProjectSprite(spritecands[i], &spritecandinterp[i]);
+		}
+
+		// I'm so smart :^)
+		if (objectsdrawn == oldobjectsdrawn)
+		{
+			/*
+			Object is invisible OR is off screen but
+			render its bbox even if the latter because
+			radius could be bigger than sprite.
+			*/
+			R_ProjectBoundingBox(spritecands[i], NULL);
 		}
 	}
 
@@ -2609,166 +2716,177 @@ static boolean R_SortVisSpriteFunc(vissprite_t *ds, fixed_t bestscale, INT32 bes
 	return false;
 }
 
+// Scratch space for R_SortVisSprites, grown as needed
+typedef struct
+{
+	fixed_t sortscale;
+	INT32 dispoffset;
+	UINT32 order; // position in the unsorted list, so equal sprites keep it
+	vissprite_t *spr;
+} vsprsortkey_t;
+
+static vsprsortkey_t *vsprsortkeys = NULL;
+static INT32 *vsprownerheads = NULL; // first possible owner of each hash, by index - start
+static INT32 *vsprownernext = NULL; // next possible owner with the same hash
+static UINT32 vsprsortsize = 0, vsprownermask = 0;
+
+#define VSPROWNERHASH(mobj) ((UINT32)(((size_t)(mobj) >> 4) * 2654435761u) & vsprownermask)
+
+static int R_CompareVisSprites(const void *p1, const void *p2)
+{
+	const vsprsortkey_t *a = p1;
+	const vsprsortkey_t *b = p2;
+
+	if (a->sortscale != b->sortscale)
+		return (a->sortscale < b->sortscale) ? -1 : 1;
+	// order visprites of same scale by dispoffset, smallest first
+	if (a->dispoffset != b->dispoffset)
+		return (a->dispoffset < b->dispoffset) ? -1 : 1;
+	return (a->order < b->order) ? -1 : (a->order > b->order);
+}
+
+static void R_GrowVisSpriteSort(UINT32 count)
+{
+	UINT32 hashsize = 16;
+
+	if (count <= vsprsortsize)
+		return;
+
+	while (hashsize < count * 2)
+		hashsize <<= 1;
+
+	vsprsortkeys = Z_Realloc(vsprsortkeys, count * sizeof (*vsprsortkeys), PU_STATIC, NULL);
+	vsprownernext = Z_Realloc(vsprownernext, count * sizeof (*vsprownernext), PU_STATIC, NULL);
+	vsprownerheads = Z_Realloc(vsprownerheads, hashsize * sizeof (*vsprownerheads), PU_STATIC, NULL);
+	vsprownermask = hashsize - 1;
+	vsprsortsize = count;
+}
+
 //
 // R_SortVisSprites
 //
+// Sorts by sortscale, then dispoffset, keeping the original order of
+// sprites that are equal in both, which is the same order repeatedly
+// picking the first smallest sprite would give.
+//
 static void R_SortVisSprites(vissprite_t* vsprsortedhead, UINT32 start, UINT32 end)
 {
-	UINT32       i, linkedvissprites = 0;
-	vissprite_t *ds, *dsprev, *dsnext, *dsfirst;
-	vissprite_t *best = NULL;
-	vissprite_t  unsorted;
-	fixed_t      bestscale;
-	INT32        bestdispoffset;
-
-	unsorted.next = unsorted.prev = &unsorted;
+	UINT32       i, count = end - start, numsorted = 0;
+	INT32        owner;
+	vissprite_t *ds, *dsfirst, *dsnext;
 
-	dsfirst = R_GetVisSprite(start);
+	R_GrowVisSpriteSort(count);
 
-	// The first's prev and last's next will be set to
-	// nonsense, but are fixed in a moment
-	for (i = start, dsnext = dsfirst, ds = NULL; i < end; i++)
+	// Hash everything a linkdraw sprite could attach to by its mobj. Each
+	// chain runs from the last sprite to the first, the order the owner
+	// used to be searched for in.
+	memset(vsprownerheads, 0xFF, (vsprownermask + 1) * sizeof (*vsprownerheads));
+	for (i = 0; i < count; i++)
 	{
-		dsprev = ds;
-		ds = dsnext;
-		if (i < end - 1) dsnext = R_GetVisSprite(i + 1);
-
-		ds->next = dsnext;
-		ds->prev = dsprev;
+		ds = R_GetVisSprite(start + i);
 		ds->linkdraw = NULL;
-	}
 
-	// Fix first and last. ds still points to the last one after the loop
-	dsfirst->prev = &unsorted;
-	unsorted.next = dsfirst;
-	if (ds)
-	{
-		ds->next = &unsorted;
-		ds->linkdraw = NULL;
+		if (ds->cut & (SC_LINKDRAW|SC_SHADOW|SC_BBOX))
+			continue;
+
+		owner = VSPROWNERHASH(ds->mobj);
+		vsprownernext[i] = vsprownerheads[owner];
+		vsprownerheads[owner] = (INT32)i;
 	}
-	unsorted.prev = ds;
 
-	// bundle linkdraw
-	for (ds = unsorted.prev; ds != &unsorted; ds = ds->prev)
+	// bundle linkdraw, last to first
+	for (i = count; i--;)
 	{
+		ds = R_GetVisSprite(start + i);
+
 		// Remove this sprite if it was determined to not be visible
 		if (ds->cut & SC_NOTVISIBLE)
-		{
-			ds->next->prev = ds->prev;
-			ds->prev->next = ds->next;
-			continue;
-		}
-
-		if (!(ds->cut & SC_LINKDRAW))
 			continue;
 
-		if (ds->cut & SC_SHADOW)
+		if (!(ds->cut & SC_LINKDRAW) || (ds->cut & SC_SHADOW))
+		{
+			vsprsortkeys[numsorted].sortscale = ds->sortscale;
+			vsprsortkeys[numsorted].dispoffset = ds->dispoffset;
+			vsprsortkeys[numsorted].order = i;
+			vsprsortkeys[numsorted].spr = ds;
+			numsorted++;
 			continue;
+		}
 
-		// reuse dsfirst...
-		for (dsfirst = unsorted.prev; dsfirst != &unsorted; dsfirst = dsfirst->prev)
+		dsfirst = NULL;
+		for (owner = vsprownerheads[VSPROWNERHASH(ds->mobj)]; owner != -1; owner = vsprownernext[owner])
 		{
-			// don't connect if it's also a link
-			if (dsfirst->cut & SC_LINKDRAW)
-				continue;
+			vissprite_t *tracer = R_GetVisSprite(start + owner);
 
-			// don't connect to your shadow!
-			if (dsfirst->cut & SC_SHADOW)
-				continue;
-
-			// don't connect to your bounding box!
-			if (dsfirst->cut & SC_BBOX)
+			// don't connect if it's not the tracer
+			if (tracer->mobj != ds->mobj)
 				continue;
 
-			// don't connect if it's not the tracer
-			if (dsfirst->mobj != ds->mobj)
+			// invisible sprites after this one were already dropped
+			if ((UINT32)owner > i && (tracer->cut & SC_NOTVISIBLE))
 				continue;
 
 			// don't connect if the tracer's top is cut off, but lower than the link's top
-			if ((dsfirst->cut & SC_TOP) && dsfirst->szt > ds->szt)
+			if ((tracer->cut & SC_TOP) && tracer->szt > ds->szt)
 				continue;
 
 			// don't connect if the tracer's bottom is cut off, but higher than the link's bottom
-			if ((dsfirst->cut & SC_BOTTOM) && dsfirst->sz < ds->sz)
+			if ((tracer->cut & SC_BOTTOM) && tracer->sz < ds->sz)
 				continue;
 
 			// If the object isn't visible, then the bounding box isn't either
-			if (ds->cut & SC_BBOX && dsfirst->cut & SC_NOTVISIBLE)
+			if (ds->cut & SC_BBOX && tracer->cut & SC_NOTVISIBLE)
 				ds->cut |= SC_NOTVISIBLE;
 
+			dsfirst = tracer;
 			break;
 		}
 
-		// remove from chain
-		ds->next->prev = ds->prev;
-		ds->prev->next = ds->next;
-
-		if (ds->cut & SC_NOTVISIBLE)
+		if (ds->cut & SC_NOTVISIBLE || dsfirst == NULL)
 			continue;
 
-		linkedvissprites++;
-
-		if (dsfirst != &unsorted)
-		{
-			if (!(ds->cut & SC_FULLBRIGHT))
-				ds->colormap = dsfirst->colormap;
-			ds->extra_colormap = dsfirst->extra_colormap;
+		if (!(ds->cut & SC_FULLBRIGHT))
+			ds->colormap = dsfirst->colormap;
+		ds->extra_colormap = dsfirst->extra_colormap;
 
-			// reusing dsnext...
-			dsnext = dsfirst->linkdraw;
+		dsnext = dsfirst->linkdraw;
 
-			if (dsnext == NULL || R_SortVisSpriteFunc(ds, dsnext->sortscale, dsnext->dispoffset) == true)
-			{
-				ds->next = dsnext;
-				dsfirst->linkdraw = ds;
-			}
-			else
+		if (dsnext == NULL || R_SortVisSpriteFunc(ds, dsnext->sortscale, dsnext->dispoffset) == true)
+		{
+			ds->next = dsnext;
+			dsfirst->linkdraw = ds;
+		}
+		else
+		{
+			for (; dsnext->next != NULL; dsnext = dsnext->next)
 			{
-				for (; dsnext->next != NULL; dsnext = dsnext->next)
+				if (R_SortVisSpriteFunc(ds, dsnext->next->sortscale, dsnext->next->dispoffset) == true)
 				{
-					if (R_SortVisSpriteFunc(ds, dsnext->next->sortscale, dsnext->next->dispoffset) == true)
-					{
-						break;
-					}
+					break;
 				}
-
-				ds->next = dsnext->next;
-				dsnext->next = ds;
 			}
+
+			ds->next = dsnext->next;
+			dsnext->next = ds;
 		}
 	}
 
-	// pull the vissprites out by scale
+	qsort(vsprsortkeys, numsorted, sizeof (*vsprsortkeys), R_CompareVisSprites);
+
+	// link the vissprites up by scale
 	vsprsortedhead->next = vsprsortedhead->prev = vsprsortedhead;
-	for (i = start; i < end-linkedvissprites; i++)
+	for (i = 0; i < numsorted; i++)
 	{
-		bestscale = bestdispoffset = INT32_MAX;
-		for (ds = unsorted.next; ds != &unsorted; ds = ds->next)
-		{
-#ifdef PARANOIA
-			if (ds->cut & SC_LINKDRAW)
-				I_Error("R_SortVisSprites: no link or discardal made for linkdraw!");
-#endif
-
-			if (R_SortVisSpriteFunc(ds, bestscale, bestdispoffset) == true)
-			{
-				bestscale = ds->sortscale;
-				bestdispoffset = ds->dispoffset;
-				best = ds;
-			}
-		}
-		if (best)
-		{
-			best->next->prev = best->prev;
-			best->prev->next = best->next;
-			best->next = vsprsortedhead;
-			best->prev = vsprsortedhead->prev;
-			vsprsortedhead->prev->next = best;
-			vsprsortedhead->prev = best;
-		}
+		ds = vsprsortkeys[i].spr;
+		ds->next = vsprsortedhead;
+		ds->prev = vsprsortedhead->prev;
+		vsprsortedhead->prev->next = ds;
+		vsprsortedhead->prev = ds;
 	}
 }
 
+#undef VSPROWNERHASH
+
 //
 // R_CreateDrawNodes
 // Creates and sorts a list of drawnodes for the scene being rendered.
@@ -2788,6 +2906,7 @@ static void R_CreateDrawNodes(maskcount_t* mask, drawnode_t* head, boolean temps
 	visplane_t *plane;
 	INT32 sintersect;
 	fixed_t scale = 0;
+	precise_t sorttime;
 
 	// Add the 3D floors, thicksides, and masked textures...
 	for (ds = drawsegs + mask->drawsegs[1]; ds-- > drawsegs + mask->drawsegs[0];)
@@ -2888,7 +3007,10 @@ static void R_CreateDrawNodes(maskcount_t* mask, drawnode_t* head, boolean temps
 	if (mask->vissprites[1] - mask->vissprites[0] == 0)
 		return;
 
+	// Once per mask, so this adds up over the frame
+	sorttime = I_GetPreciseTime();
 	R_SortVisSprites(&vsprsortedhead, mask->vissprites[0], mask->vissprites[1]);
+	ps_sw_spritesorttime.value.p += I_GetPreciseTime() - sorttime;
 
 	for (rover = vsprsortedhead.prev; rover != &vsprsortedhead; rover = rover->prev)
 	{
@@ -3483,6 +3605,7 @@ void R_ClipSprites(drawseg_t* dsstart, portal_t* portal)
 		&& !((spr->cut & SC_SPLAT) || spr->scalestep))
 		{
 			spr->cut |= SC_NOTVISIBLE;
+			ps_spritesclipped.value.i++;
 			continue;
 		}
 
@@ -3515,6 +3638,8 @@ void R_ClipSprites(drawseg_t* dsstart, portal_t* portal)
 
 		if ((spr->cut & SC_NOTVISIBLE) == 0)
 			numvisiblesprites++;
+		else
+			ps_spritesclipped.value.i++;
 	}
 }
 
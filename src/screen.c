@@ -281,6 +281,8 @@ void SCR_Startup(void)
 
 	CV_RegisterVar(&cv_ticrate);
 	CV_RegisterVar(&cv_constextsize);
+	CV_RegisterVar(&cv_dirtyrects);
+	CV_RegisterVar(&cv_showdirtyrects);
 
 	V_SetPalette(0);
 }
@@ -312,12 +312,12 @@ static void LoadPalette(const char *lumpname)
 {
 	lumpnum_t lumpnum = W_GetNumForName(lumpname);
 	size_t i, palsize = W_LumpLength(lumpnum)/3;
+	RGBA_t *oldpalette = pMasterPalette;
 	UINT8 *pal;
 
 	Cubeapply = InitCube();
 
 	Z_Free(pLocalPalette);
-	Z_Free(pMasterPalette);
 
 	pLocalPalette = Z_Malloc(sizeof (*pLocalPalette)*palsize, PU_STATIC, NULL);
 	pMasterPalette = Z_Malloc(sizeof (*pMasterPalette)*palsize, PU_STATIC, NULL);
@@ -340,6 +340,11 @@ static void LoadPalette(const char *lumpname)
 		if (Cubeapply)
 			V_CubeApply(&pLocalPalette[i].s.red, &pLocalPalette[i].s.green, &pLocalPalette[i].s.blue);
 	}
+
+	// Mipmaps are filtered through the palette, so they have to be rebuilt
+	if (oldpalette && memcmp(oldpalette, pMasterPalette, sizeof (*pMasterPalette)*256))
+		R_FlushMips();
+	Z_Free(oldpalette);
 }
 
 void V_CubeApply(UINT8 *red, UINT8 *green, UINT8 *blue)
@@ -474,6 +479,251 @@ void VID_BlitLinearScreen(const UINT8 *srcptr, UINT8 *destptr, INT32 width, INT3
 	}
 }
 
+// --------------------------------------------------------------------------
+// Cached screen layer with dirty rectangles (Software only)
+//
+// A static background, such as the intermission's, is drawn once into a
+// buffer. On the frames after that, only the parts of the screen that
+// were drawn over in the previous frame are restored from the buffer,
+// instead of drawing the whole background again.
+// --------------------------------------------------------------------------
+
+consvar_t cv_dirtyrects = CVAR_INIT ("dirtyrects", "Off", CV_SAVE, CV_OnOff, NULL);
+consvar_t cv_showdirtyrects = CVAR_INIT ("showdirtyrects", "Off", 0, CV_OnOff, NULL);
+
+#define MAXDIRTYRECTS 128
+#define DIRTYRECTCOLOR 35
+
+typedef struct
+{
+	INT32 x1, y1, x2, y2; // x2 and y2 are exclusive
+} dirtyrect_t;
+
+typedef struct
+{
+	dirtyrect_t rects[MAXDIRTYRECTS];
+	size_t numrects;
+	boolean full; // Out of rects, or the whole screen was drawn over
+} dirtylist_t;
+
+static struct
+{
+	UINT8 *buffer;
+	INT32 width, height;
+
+	boolean valid; // The buffer holds the layer
+	boolean capturing; // The layer is being drawn to screens[0]
+	boolean tracking; // Draws to screens[0] are being recorded
+	boolean onscreen; // screens[0] holds the layer, plus what the last frame drew over it
+
+	dirtylist_t drawn; // Drawn over the layer this frame
+	dirtylist_t overlay; // Covered by the showdirtyrects outlines this frame
+} vlayer;
+
+static void V_AddDirtyRect(dirtylist_t *list, INT32 x1, INT32 y1, INT32 x2, INT32 y2)
+{
+	const INT32 slack = 8*vid.dupx; // Enough to merge the characters of a string
+	dirtyrect_t *rect;
+
+	if (list->full)
+		return;
+
+	if (x1 < 0)
+		x1 = 0;
+	if (y1 < 0)
+		y1 = 0;
+	if (x2 > vid.width)
+		x2 = vid.width;
+	if (y2 > vid.height)
+		y2 = vid.height;
+
+	if (x1 >= x2 || y1 >= y2)
+		return;
+
+	if (x1 == 0 && y1 == 0 && x2 == vid.width && y2 == vid.height)
+	{
+		list->full = true;
+		return;
+	}
+
+	// Grow the last rect if this one is next to it
+	if (list->numrects)
+	{
+		rect = &list->rects[list->numrects - 1];
+		if (x1 <= rect->x2 + slack && x2 + slack >= rect->x1
+			&& y1 <= rect->y2 && y2 >= rect->y1)
+		{
+			rect->x1 = min(rect->x1, x1);
+			rect->y1 = min(rect->y1, y1);
+			rect->x2 = max(rect->x2, x2);
+			rect->y2 = max(rect->y2, y2);
+			return;
+		}
+	}
+
+	if (list->numrects == MAXDIRTYRECTS)
+	{
+		list->full = true;
+		return;
+	}
+
+	rect = &list->rects[list->numrects++];
+	rect->x1 = x1;
+	rect->y1 = y1;
+	rect->x2 = x2;
+	rect->y2 = y2;
+}
+
+// Called by the drawers below for everything they draw to screens[0]
+static void V_MarkDirty(INT32 x, INT32 y, INT32 w, INT32 h)
+{
+	if (vlayer.tracking)
+		V_AddDirtyRect(&vlayer.drawn, x, y, x + w, y + h);
+}
+
+static void V_StartDirtyTracking(void)
+{
+	vlayer.drawn.numrects = vlayer.overlay.numrects = 0;
+	vlayer.drawn.full = vlayer.overlay.full = false;
+	vlayer.tracking = true;
+}
+
+static void V_RestoreDirtyList(const dirtylist_t *list)
+{
+	const dirtyrect_t *rect;
+	size_t i, ofs;
+	INT32 y;
+
+	if (list->full)
+	{
+		M_Memcpy(screens[0], vlayer.buffer, vid.width * vid.height);
+		return;
+	}
+
+	for (i = 0, rect = list->rects; i < list->numrects; i++, rect++)
+	{
+		for (y = rect->y1; y < rect->y2; y++)
+		{
+			ofs = y*vid.width + rect->x1;
+			M_Memcpy(screens[0] + ofs, vlayer.buffer + ofs, rect->x2 - rect->x1);
+		}
+	}
+}
+
+// Outlines the restored rects. The outlines aren't tracked as drawn,
+// or they would keep their own area dirty forever.
+static void V_DrawDirtyOverlay(const dirtylist_t *list)
+{
+	dirtyrect_t whole = {0, 0, 0, 0};
+	const dirtyrect_t *rect = list->rects;
+	size_t i, numrects = list->numrects;
+	INT32 y;
+
+	if (list->full)
+	{
+		whole.x2 = vid.width;
+		whole.y2 = vid.height;
+		rect = &whole;
+		numrects = 1;
+	}
+
+	for (i = 0; i < numrects; i++, rect++)
+	{
+		memset(screens[0] + rect->y1*vid.width + rect->x1, DIRTYRECTCOLOR, rect->x2 - rect->x1);
+		memset(screens[0] + (rect->y2 - 1)*vid.width + rect->x1, DIRTYRECTCOLOR, rect->x2 - rect->x1);
+		for (y = rect->y1; y < rect->y2; y++)
+			screens[0][y*vid.width + rect->x1] = screens[0][y*vid.width + rect->x2 - 1] = DIRTYRECTCOLOR;
+
+		V_AddDirtyRect(&vlayer.overlay, rect->x1, rect->y1, rect->x2, rect->y2);
+	}
+}
+
+/** Starts drawing over the cached layer. If the layer needs to be
+  * (re)drawn, draw it to screens[0] and call V_EndCachedLayer.
+  * Otherwise, the screen is restored from the cache.
+  *
+  * \return True if the caller must draw the layer.
+  */
+boolean V_BeginCachedLayer(void)
+{
+	dirtylist_t restored;
+
+	if (!cv_dirtyrects.value || rendermode != render_soft || !screens[0])
+	{
+		vlayer.valid = false;
+		return true;
+	}
+
+	if (!vlayer.valid || vlayer.width != vid.width || vlayer.height != vid.height)
+	{
+		if (!vlayer.buffer || vlayer.width != vid.width || vlayer.height != vid.height)
+		{
+			if (vlayer.buffer)
+				Z_Free(vlayer.buffer);
+			vlayer.buffer = Z_Malloc(vid.width * vid.height, PU_STATIC, NULL);
+			vlayer.width = vid.width;
+			vlayer.height = vid.height;
+		}
+
+		vlayer.valid = false;
+		vlayer.capturing = true;
+		return true;
+	}
+
+	if (vlayer.onscreen)
+	{
+		V_RestoreDirtyList(&vlayer.overlay);
+		V_RestoreDirtyList(&vlayer.drawn);
+		restored = vlayer.drawn;
+	}
+	else
+	{
+		// Something else was on screen, bring back the whole layer
+		M_Memcpy(screens[0], vlayer.buffer, vid.width * vid.height);
+		restored.numrects = 0;
+		restored.full = true;
+	}
+
+	V_StartDirtyTracking();
+
+	if (cv_showdirtyrects.value)
+		V_DrawDirtyOverlay(&restored);
+
+	return false;
+}
+
+/** Stores the layer that was just drawn to screens[0].
+  */
+void V_EndCachedLayer(void)
+{
+	if (!vlayer.capturing)
+		return;
+
+	M_Memcpy(vlayer.buffer, screens[0], vid.width * vid.height);
+	vlayer.capturing = false;
+	vlayer.valid = true;
+
+	V_StartDirtyTracking();
+}
+
+/** Makes the next V_BeginCachedLayer draw the layer again.
+  */
+void V_InvalidateCachedLayer(void)
+{
+	vlayer.valid = false;
+}
+
+/** Ends dirty rectangle tracking for this frame.
+  *
+  * \param intact False if screens[0] was changed behind the tracker's
+  *               back, as wipes do.
+  */
+void V_EndDirtyFrame(boolean intact)
+{
+	vlayer.onscreen = vlayer.tracking && intact;
+	vlayer.tracking = false;
+}
+
 static UINT8 hudplusalpha[11]  = { 10,  8,  6,  4,  2,  0,  0,  0,  0,  0,  0};
 static UINT8 hudminusalpha[11] = { 10,  9,  9,  8,  8,  7,  7,  6,  6,  5,  5};
 
@@ -746,6 +996,9 @@ void V_DrawStretchyFixedPatch(fixed_t x, fixed_t y, fixed_t pscale, fixed_t vsca
 	deststart = desttop;
 	destend = desttop + pwidth;
 
+	if (!(scrn & V_PARAMMASK))
+		V_MarkDirty(x, y, pwidth + 1, FixedInt(FixedMul(patch->height<<FRACBITS, vdup)) + 1);
+
 	for (col = 0; (col>>FRACBITS) < patch->width; col += colfrac, ++offx, desttop++)
 	{
 		INT32 topdelta, prevdelta = -1;
@@ -1001,6 +1254,9 @@ void V_DrawCroppedPatch(fixed_t x, fixed_t y, fixed_t pscale, fixed_t vscale, IN
 		desttop += (y*vid.width) + x;
 	}
 
+	if (!(scrn & V_PARAMMASK))
+		V_MarkDirty(x, y, FixedInt(FixedMul(min(w, patch->width<<FRACBITS), fdup)) + 1, FixedInt(FixedMul(min(h, patch->height<<FRACBITS), vdup)) + 1);
+
 	// Auto-crop at splitscreen borders!
 	if (splitscreen && (scrn & V_PERPLAYER))
 	{
@@ -1104,6 +1360,9 @@ void V_DrawBlock(INT32 x, INT32 y, INT32 scrn, INT32 width, INT32 height, const
 	dest = screens[scrn] + y*vid.width + x;
 	deststop = screens[scrn] + vid.rowbytes * vid.height;
 
+	if (!scrn)
+		V_MarkDirty(x, y, width, height);
+
 	while (height--)
 	{
 		M_Memcpy(dest, src, width);
@@ -1154,6 +1413,9 @@ static void V_BlitScaledPic(INT32 rx1, INT32 ry1, INT32 scrn, pic_t * pic)
 		height = (vid.width - ry1) / vid.dupy - 1;
 	// WARNING no x clipping (not needed for the moment)
 
+	if (!scrn)
+		V_MarkDirty(max(0, rx1), max(0, ry1), width * vid.dupx, height * vid.dupy);
+
 	for (y = max(0, -ry1 / vid.dupy); y < height; y++)
 	{
 		for (dupy = vid.dupy; dupy; dupy--)
@@ -1267,6 +1529,7 @@ void V_DrawFill(INT32 x, INT32 y, INT32 w, INT32 h, INT32 c)
 		if (x == 0 && y == 0 && w == BASEVIDWIDTH && h == BASEVIDHEIGHT)
 		{ // Clear the entire screen, from dest to deststop. Yes, this really works.
 			memset(screens[0], (c&255), vid.width * vid.height * vid.bpp);
+			V_MarkDirty(0, 0, vid.width, vid.height);
 			return;
 		}
 
@@ -1323,6 +1586,8 @@ void V_DrawFill(INT32 x, INT32 y, INT32 w, INT32 h, INT32 c)
 	if (y + h > vid.height)
 		h = vid.height - y;
 
+	V_MarkDirty(x, y, w, h);
+
 	dest = screens[0] + y*vid.width + x;
 	deststop = screens[0] + vid.rowbytes * vid.height;
 
@@ -1526,6 +1791,8 @@ void V_DrawFillConsoleMap(INT32 x, INT32 y, INT32 w, INT32 h, INT32 c)
 	if (y + h > vid.height)
 		h = vid.height-y;
 
+	V_MarkDirty(x, y, w, h);
+
 	dest = screens[0] + y*vid.width + x;
 	deststop = screens[0] + vid.rowbytes * vid.height;
 
@@ -1710,6 +1977,8 @@ void V_DrawFadeFill(INT32 x, INT32 y, INT32 w, INT32 h, INT32 c, UINT16 color, U
 	if (y + h > vid.height)
 		h = vid.height-y;
 
+	V_MarkDirty(x, y, w, h);
+
 	dest = screens[0] + y*vid.width + x;
 	deststop = screens[0] + vid.rowbytes * vid.height;
 
@@ -1774,6 +2043,8 @@ void V_DrawFlatFill(INT32 x, INT32 y, INT32 w, INT32 h, lumpnum_t flatnum)
 	w *= dupx;
 	h *= dupy;
 
+	V_MarkDirty((INT32)((dest - screens[0]) % vid.width), (INT32)((dest - screens[0]) / vid.width), w, h);
+
 	dx = FixedDiv(FRACUNIT, dupx<<(FRACBITS-2));
 	dy = FixedDiv(FRACUNIT, dupy<<(FRACBITS-2));
 
@@ -1836,6 +2107,8 @@ void V_DrawFadeScreen(UINT16 color, UINT8 strength)
 		const UINT8 *deststop = screens[0] + vid.rowbytes * vid.height;
 		UINT8 *buf = screens[0];
 
+		V_MarkDirty(0, 0, vid.width, vid.height);
+
 		// heavily simplified -- we don't need to know x or y
 		// position when we're doing a full screen fade
 		for (; buf < deststop; ++buf)
@@ -1860,6 +2133,7 @@ void V_DrawFadeConsBack(INT32 plines)
 	// heavily simplified -- we don't need to know x or y position,
 	// just the stop position
 	deststop = screens[0] + vid.rowbytes * min(plines, vid.height);
+	V_MarkDirty(0, 0, vid.width, min(plines, vid.height));
 	for (buf = screens[0]; buf < deststop; ++buf)
 		*buf = consolebgmap[*buf];
 }
@@ -1926,6 +2200,7 @@ void V_DrawPromptBack(INT32 boxheight, INT32 color)
 		buf += vid.rowbytes * boxheight;
 	else // 4 lines of space plus gaps between and some leeway
 		buf -= vid.rowbytes * ((boxheight * 4) + (boxheight/2)*5);
+	V_MarkDirty(0, (INT32)((buf - screens[0]) / vid.rowbytes), vid.width, vid.height);
 	for (; buf < deststop; ++buf)
 		*buf = promptbgmap[*buf];
 }
@@ -3713,7 +3988,7 @@ void InitColorLUT(colorlookup_t *lut, RGBA_t *palette, boolean makecolors)
 		lut->init = true;
 		memcpy(lut->palette, palette, palsize);
 
-		for (i = 0; i < 0xFFFF; i++)
+		for (i = 0; i < 0x10000; i++)
 			lut->table[i] = 0xFFFF;
 
 		if (makecolors)
@@ -3771,6 +4046,9 @@ void V_Init(void)
 	if (vid.direct)
 		screens[0] = vid.direct;
 
+	// New screen buffers don't hold any cached layer
+	vlayer.onscreen = false;
+
 #ifdef DEBUG
 	CONS_Debug(DBG_RENDER, "V_Init done:\n");
 	for (i = 0; i < NUMSCREENS; i++)
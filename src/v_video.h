@@ -31,7 +31,8 @@ extern consvar_t cv_ticrate, cv_constextsize,
 cv_globalgamma, cv_globalsaturation,
 cv_rhue, cv_yhue, cv_ghue, cv_chue, cv_bhue, cv_mhue,
 cv_rgamma, cv_ygamma, cv_ggamma, cv_cgamma, cv_bgamma, cv_mgamma,
-cv_rsaturation, cv_ysaturation, cv_gsaturation, cv_csaturation, cv_bsaturation, cv_msaturation;
+cv_rsaturation, cv_ysaturation, cv_gsaturation, cv_csaturation, cv_bsaturation, cv_msaturation,
+cv_dirtyrects, cv_showdirtyrects;
 
 // Allocates buffer screens, call before R_Init.
 void V_Init(void);
@@ -46,7 +47,7 @@ typedef struct
 {
 	boolean init;
 	RGBA_t palette[256];
-	UINT16 table[0xFFFF];
+	UINT16 table[0x10000];
 } colorlookup_t;
 
 void InitColorLUT(colorlookup_t *lut, RGBA_t *palette, boolean makecolors);
@@ -279,6 +280,12 @@ void V_DoPostProcessor(INT32 view, postimg_t type, INT32 param);
 
 void V_DrawPatchFill(patch_t *pat);
 
+// Cached screen layer, with only dirty rectangles restored every frame
+boolean V_BeginCachedLayer(void);
+void V_EndCachedLayer(void);
+void V_InvalidateCachedLayer(void);
+void V_EndDirtyFrame(boolean intact);
+
 void VID_BlitLinearScreen(const UINT8 *srcptr, UINT8 *destptr, INT32 width, INT32 height, size_t srcrowbytes,
 	size_t destrowbytes);
 
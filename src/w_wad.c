@@ -33,6 +33,14 @@
 #include <unistd.h>
 #endif
 
+#if defined (__unix__) || defined (__APPLE__) || defined (UNIXCOMMON)
+#define SHAREDASSETS
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #define ZWAD
 
 #ifdef ZWAD
@@ -63,6 +71,7 @@
 #include "i_system.h"
 #include "i_video.h" // rendermode
 #include "md5.h"
+#include "m_argv.h"
 #include "lua_script.h"
 #ifdef SCANTHINGS
 #include "p_setup.h" // P_ScanThings
@@ -121,6 +130,10 @@ void W_Shutdown(void)
 
 		if (wad->handle)
 			fclose(wad->handle);
+#ifdef SHAREDASSETS
+		if (wad->mapped)
+			munmap(wad->mapped, wad->mappedsize);
+#endif
 		Z_Free(wad->filename);
 		if (wad->path)
 			Z_Free(wad->path);
@@ -829,6 +842,245 @@ static void W_ReadFileShaders(wadfile_t *wadfile)
 #endif
 }
 
+#ifdef SHAREDASSETS
+// With -sharedassets, lumps are read out of a read-only mapping instead
+// of through the file handle, so that server processes on a host skip
+// the file reads and decompression, and share the page cache for the raw
+// lump data. Lumps cached through W_CacheLumpNum are still copied into
+// private zone blocks, since callers retag and free them.
+// Files whose lumps are all stored as they are get mapped directly. For
+// the others, the first process to load them writes the decompressed
+// lumps to srb2home/assetcache, under the file's MD5, and every process
+// maps that instead. A cache file that doesn't match is rebuilt, and if
+// anything fails the file is read normally.
+#define ASSETCACHE_DIR "assetcache"
+#define ASSETCACHE_MAGIC "SRB2ASC1"
+#define ASSETCACHE_MAXSIZE ((size_t)1024*1024*1024) // least recently used caches are deleted past this
+
+typedef struct
+{
+	char magic[8];
+	UINT8 md5sum[16];
+	UINT32 filesize; // of the file the lumps came from
+	UINT32 numlumps;
+	// followed by UINT32 offsets[numlumps], then the lumps
+} assetcacheheader_t;
+
+static UINT8 *W_MapPath(const char *path, size_t *size)
+{
+	struct stat st;
+	void *map;
+	int fd = open(path, O_RDONLY);
+
+	if (fd == -1)
+		return NULL;
+	if (fstat(fd, &st) == -1 || st.st_size <= 0)
+	{
+		close(fd);
+		return NULL;
+	}
+
+	map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd); // the mapping stays valid
+	if (map == MAP_FAILED)
+		return NULL;
+
+	*size = (size_t)st.st_size;
+	return map;
+}
+
+// Checks that a mapped asset cache belongs to the file, and that the
+// offset table and every lump in it lie within the mapping.
+static boolean W_CheckAssetCache(const wadfile_t *wadfile, const UINT8 *map, size_t mapsize)
+{
+	const assetcacheheader_t *header = (const assetcacheheader_t *)map;
+	const UINT32 *offsets = (const UINT32 *)(header + 1);
+	size_t datastart = sizeof (*header) + wadfile->numlumps * sizeof (UINT32);
+	UINT16 i;
+
+	if (mapsize < sizeof (*header)
+	|| memcmp(header->magic, ASSETCACHE_MAGIC, sizeof (header->magic))
+	|| memcmp(header->md5sum, wadfile->md5sum, sizeof (header->md5sum))
+	|| header->filesize != wadfile->filesize || header->numlumps != wadfile->numlumps
+	|| mapsize < datastart)
+		return false;
+
+	for (i = 0; i < wadfile->numlumps; i++)
+	{
+		size_t size = wadfile->lumpinfo[i].size;
+		if (size && (offsets[i] < datastart || offsets[i] > mapsize || size > mapsize - offsets[i]))
+			return false;
+	}
+
+	return true;
+}
+
+// Decompresses every lump of a file into its asset cache.
+static boolean W_WriteAssetCache(UINT16 wad, const char *path)
+{
+	wadfile_t *wadfile = wadfiles[wad];
+	assetcacheheader_t header;
+	char temppath[256+48];
+	UINT32 *offsets;
+	UINT64 position;
+	FILE *handle;
+	boolean ok;
+	UINT16 i;
+
+	I_mkdir(va("%s" PATHSEP ASSETCACHE_DIR, srb2home), 0755);
+	prunecachedirectory(va("%s" PATHSEP ASSETCACHE_DIR, srb2home), ".dat", ASSETCACHE_MAXSIZE);
+
+	memset(&header, 0, sizeof (header));
+	memcpy(header.magic, ASSETCACHE_MAGIC, sizeof (header.magic));
+	memcpy(header.md5sum, wadfile->md5sum, sizeof (header.md5sum));
+	header.filesize = wadfile->filesize;
+	header.numlumps = wadfile->numlumps;
+
+	offsets = Z_Calloc(wadfile->numlumps * sizeof (UINT32), PU_STATIC, NULL);
+	position = sizeof (header) + wadfile->numlumps * sizeof (UINT32);
+	for (i = 0; i < wadfile->numlumps; i++)
+	{
+		if (!wadfile->lumpinfo[i].size)
+			continue;
+		offsets[i] = (UINT32)position;
+		position += wadfile->lumpinfo[i].size;
+	}
+
+	if (position > UINT32_MAX)
+	{
+		Z_Free(offsets);
+		return false;
+	}
+
+	// Every process writes its own temporary file, and the finished one
+	// is renamed over the real name, so nobody maps a half-written cache.
+	snprintf(temppath, sizeof (temppath), "%s.%d.tmp", path, (int)getpid());
+	handle = fopen(temppath, "wb");
+	if (!handle)
+	{
+		Z_Free(offsets);
+		return false;
+	}
+
+	ok = (fwrite(&header, sizeof (header), 1, handle) == 1
+		&& fwrite(offsets, sizeof (UINT32), wadfile->numlumps, handle) == wadfile->numlumps);
+	Z_Free(offsets);
+
+	for (i = 0; ok && i < wadfile->numlumps; i++)
+	{
+		size_t size = wadfile->lumpinfo[i].size;
+		void *lump;
+
+		if (!size)
+			continue;
+
+		lump = Z_Malloc(size, PU_STATIC, NULL);
+		ok = (W_ReadLumpHeaderPwad(wad, i, lump, 0, 0) == size && fwrite(lump, 1, size, handle) == size);
+		Z_Free(lump);
+	}
+
+	ok = (fclose(handle) == 0 && ok);
+	if (!ok || rename(temppath, path))
+	{
+		remove(temppath);
+		return false;
+	}
+
+	return true;
+}
+
+/** Maps a file's lumps read-only, if -sharedassets was given.
+  *
+  * \param wad The file to map. Its lumps are read normally if this fails.
+  */
+static void W_MapSharedAssets(UINT16 wad)
+{
+	static INT32 sharedassets = -1;
+	wadfile_t *wadfile = wadfiles[wad];
+	UINT8 *map;
+	char path[256+32];
+	size_t mapsize = 0;
+	UINT16 i;
+
+	if (sharedassets == -1)
+		sharedassets = M_CheckParm("-sharedassets");
+	if (!sharedassets || !wadfile->numlumps)
+		return;
+
+	for (i = 0; i < wadfile->numlumps; i++)
+		if (wadfile->lumpinfo[i].compression != CM_NOCOMPRESSION)
+			break;
+
+	if (i == wadfile->numlumps)
+	{
+		map = W_MapPath(wadfile->filename, &mapsize);
+
+		// A truncated file can list lumps past its end.
+		if (map && mapsize == wadfile->filesize)
+		{
+			for (i = 0; i < wadfile->numlumps; i++)
+			{
+				const lumpinfo_t *l = &wadfile->lumpinfo[i];
+				if (l->size && (l->position > mapsize || l->size > mapsize - l->position))
+					break;
+			}
+		}
+
+		if (map == NULL || mapsize != wadfile->filesize || i < wadfile->numlumps)
+		{
+			if (map)
+				munmap(map, mapsize);
+			CONS_Alert(CONS_WARNING, "Couldn't map %s, reading it normally\n", wadfile->filename);
+			return;
+		}
+
+		wadfile->mapped = map;
+		wadfile->mappedsize = mapsize;
+		return;
+	}
+
+#ifdef NOMD5
+	return; // the cache is named and validated by the MD5
+#else
+	snprintf(path, sizeof (path), "%s" PATHSEP ASSETCACHE_DIR PATHSEP, srb2home);
+	for (i = 0; i < 16; i++)
+		snprintf(path + strlen(path), sizeof (path) - strlen(path), "%02x", wadfile->md5sum[i]);
+	strlcat(path, ".dat", sizeof (path));
+
+	map = W_MapPath(path, &mapsize);
+	if (map && !W_CheckAssetCache(wadfile, map, mapsize))
+	{
+		munmap(map, mapsize);
+		map = NULL;
+	}
+	else if (map)
+		touchcachefile(path);
+
+	if (map == NULL)
+	{
+		CONS_Printf(M_GetText("Building shared asset cache for %s\n"), wadfile->filename);
+		if (W_WriteAssetCache(wad, path))
+			map = W_MapPath(path, &mapsize);
+		if (map && !W_CheckAssetCache(wadfile, map, mapsize))
+		{
+			munmap(map, mapsize);
+			map = NULL;
+		}
+	}
+
+	if (map == NULL)
+	{
+		CONS_Alert(CONS_WARNING, "Couldn't use the shared asset cache for %s, reading it normally\n", wadfile->filename);
+		return;
+	}
+
+	wadfile->mapped = map;
+	wadfile->mappedsize = mapsize;
+	wadfile->mappedoffsets = (const UINT32 *)(map + sizeof (assetcacheheader_t));
+#endif
+}
+#endif
+
 //  Allocate a wadfile, setup the lumpinfo (directory) and
 //  lumpcache, add the wadfile to the current active wadfiles
 //
@@ -955,6 +1207,9 @@ UINT16 W_InitFile(const char *filename, boolean mainfile, boolean startup)
 	wadfile->foldercount = 0;
 	wadfile->lumpinfo = lumpinfo;
 	wadfile->important = important;
+	wadfile->mapped = NULL;
+	wadfile->mappedsize = 0;
+	wadfile->mappedoffsets = NULL;
 	fseek(handle, 0, SEEK_END);
 	wadfile->filesize = (unsigned)ftell(handle);
 	wadfile->type = type;
@@ -976,6 +1231,10 @@ UINT16 W_InitFile(const char *filename, boolean mainfile, boolean startup)
 	wadfiles[numwadfiles] = wadfile;
 	numwadfiles++; // must come BEFORE W_LoadDehackedLumps, so any addfile called by COM_BufInsertText called by Lua doesn't overwrite what we just loaded
 
+#ifdef SHAREDASSETS
+	W_MapSharedAssets(numwadfiles - 1);
+#endif
+
 	// Read shaders from file
 	W_ReadFileShaders(wadfile);
 
@@ -1141,6 +1400,9 @@ UINT16 W_InitFolder(const char *path, boolean mainfile, boolean startup)
 	wadfile->foldercount = foldercount;
 	wadfile->lumpinfo = lumpinfo;
 	wadfile->important = important;
+	wadfile->mapped = NULL;
+	wadfile->mappedsize = 0;
+	wadfile->mappedoffsets = NULL;
 
 	// Irrelevant.
 	wadfile->filesize = 0;
@@ -1751,6 +2013,23 @@ size_t W_ReadLumpHeaderPwad(UINT16 wad, UINT16 lump, void *dest, size_t size, si
 	if (!size || size+offset > lumpsize)
 		size = lumpsize - offset;
 
+	// Mapped with -sharedassets; already decompressed.
+	if (wadfiles[wad]->mapped)
+	{
+		const UINT8 *data = wadfiles[wad]->mapped;
+
+		if (wadfiles[wad]->mappedoffsets)
+			data += wadfiles[wad]->mappedoffsets[lump];
+		else
+			data += l->position;
+		M_Memcpy(dest, data + offset, size);
+#ifdef NO_PNG_LUMPS
+		if (Picture_IsLumpPNG((UINT8 *)dest, size))
+			Picture_ThrowPNGError(l->fullname, wadfiles[wad]->filename);
+#endif
+		return size;
+	}
+
 	// Let's get the raw lump data.
 	// We setup the desired file handle to read the lump data.
 	if (wadfiles[wad]->type != RET_FOLDER)
@@ -135,6 +135,10 @@ typedef struct wadfile_s
 	UINT8 md5sum[16];
 
 	boolean important; // also network - !W_VerifyNMUSlumps
+
+	UINT8 *mapped; // read-only mapping lumps are read from, for -sharedassets
+	size_t mappedsize;
+	const UINT32 *mappedoffsets; // of each lump in the mapping; NULL when the file itself is mapped
 } wadfile_t;
 
 #define WADFILENUM(lumpnum) (UINT16)((lumpnum)>>16) // wad file number in upper word
@@ -235,6 +235,9 @@ void Y_LoadIntermissionData(void)
 	if (dedicated)
 		return;
 
+	// New background to draw
+	V_InvalidateCachedLayer();
+
 	switch (intertype)
 	{
 		case int_coop:
@@ -390,19 +393,12 @@ void Y_CleanupScreenBuffer(void)
 }
 
 //
-// Y_IntermissionDrawer
+// Y_DrawBackground
 //
-// Called by D_Display. Nothing is modified here; all it does is draw.
-// Neat concept, huh?
+// Draws whatever is behind the tally.
 //
-void Y_IntermissionDrawer(void)
+static void Y_DrawBackground(void)
 {
-	// Bonus loops
-	INT32 i;
-
-	if (intertype == int_none || rendermode == render_none)
-		return;
-
 	if (useinterpic)
 		V_DrawScaledPatch(0, 0, 0, interpic);
 	else if (!usetile)
@@ -435,6 +431,29 @@ void Y_IntermissionDrawer(void)
 	}
 	else if (bgtile)
 		V_DrawPatchFill(bgtile);
+}
+
+//
+// Y_IntermissionDrawer
+//
+// Called by D_Display. Nothing is modified here; all it does is draw.
+// Neat concept, huh?
+//
+void Y_IntermissionDrawer(void)
+{
+	// Bonus loops
+	INT32 i;
+
+	if (intertype == int_none || rendermode == render_none)
+		return;
+
+	// The background doesn't change, so draw it once
+	// and only bring back the parts drawn over it since
+	if (V_BeginCachedLayer())
+	{
+		Y_DrawBackground();
+		V_EndCachedLayer();
+	}
 
 	if (renderisnewtic)
 	{
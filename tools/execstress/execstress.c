@@ -0,0 +1,216 @@
+#define HELP \
+"Usage: execstress WAD-file [triggers] [executors]"                       "\n"\
+"Write a UDMF stress map for linedef executor dispatch as MAP01."          "\n"\
+"\n"\
+"The player spawns in a room whose floor triggers every trigger linedef"   "\n"\
+"each tic. Each trigger lives in its own control sector, together with"    "\n"\
+"'executors' copy light executors aimed at an unused tag."                 "\n"\
+"Defaults are 2000 triggers and 7 executors per trigger."                  "\n"\
+"\n"\
+"The map has no nodes; build them with a UDMF node builder (ZDBSP)"        "\n"\
+"before loading it, e.g. zdbsp -X -o stress.wad execstress.wad"            "\n"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define TRIGGERTAG 1
+#define UNUSEDTAG 32000
+
+#define ROOMSIZE 1024
+#define CTLRADIUS 32
+#define CTLSPACING 128
+#define CTLPERROW 64
+
+static void
+write_u32 (unsigned char *p, unsigned long v)
+{
+	p[0] = v;
+	p[1] = v >> 8;
+	p[2] = v >> 16;
+	p[3] = v >> 24;
+}
+
+static char *buf;
+static size_t buflen, bufmax;
+
+static void
+emit (const char *fmt, ...)
+{
+	va_list ap;
+	int n;
+
+	for (;;)
+	{
+		va_start (ap, fmt);
+		n = vsnprintf(&buf[buflen], bufmax - buflen, fmt, ap);
+		va_end (ap);
+
+		if (n < 0)
+			abort();
+
+		if (buflen + n < bufmax)
+			break;
+
+		bufmax = bufmax * 2 + n + 1;
+		if (!( buf = realloc(buf, bufmax) ))
+			abort();
+	}
+
+	buflen += n;
+}
+
+static int
+vertex (double x, double y)
+{
+	static int n;
+	emit("vertex { x = %.3f; y = %.3f; }\n", x, y);
+	return n++;
+}
+
+static int
+sidedef (int sector)
+{
+	static int n;
+	emit("sidedef { sector = %d; texturemiddle = \"GFZROCK\"; }\n", sector);
+	return n++;
+}
+
+static int
+sector (int floor, int ceiling, int triggertag)
+{
+	static int n;
+	emit("sector { heightfloor = %d; heightceiling = %d; "
+			"texturefloor = \"GFZFLR01\"; textureceiling = \"F_SKY1\"; "
+			"lightlevel = 255;", floor, ceiling);
+	if (triggertag)
+		emit(" triggertag = %d;", triggertag);
+	emit(" }\n");
+	return n++;
+}
+
+static void
+linedef (int v1, int v2, int side, int special, int tag, int arg0)
+{
+	emit("linedef { v1 = %d; v2 = %d; sidefront = %d; blocking = true;",
+			v1, v2, side);
+	if (special)
+		emit(" special = %d; id = %d; arg0 = %d;", special, tag, arg0);
+	emit(" }\n");
+}
+
+/* Clockwise polygon, so the front sides face inward. */
+static void
+polygon (int sec, int sides, double cx, double cy, double r,
+		int firstspecial, int firsttag)
+{
+	int first = 0;
+	int prev = 0;
+	int i;
+
+	for (i = 0; i < sides; ++i)
+	{
+		double a = -2.0 * M_PI * i / sides;
+		int v = vertex(cx + r * cos(a), cy + r * sin(a));
+
+		if (i == 0)
+			first = v;
+		else if (i == 1)
+			linedef(prev, v, sidedef(sec), firstspecial, firsttag, 0);
+		else
+			linedef(prev, v, sidedef(sec), firstspecial ? 402 : 0,
+					UNUSEDTAG, UNUSEDTAG);
+
+		prev = v;
+	}
+
+	linedef(prev, first, sidedef(sec), firstspecial ? 402 : 0,
+			UNUSEDTAG, UNUSEDTAG);
+}
+
+int
+main (int ac, char **av)
+{
+	FILE *f;
+	unsigned char header[12];
+	unsigned char dir[3][16];
+	int triggers = 2000;
+	int executors = 7;
+	int room;
+	int i;
+
+	if (ac < 2)
+	{
+		fputs(HELP, stderr);
+		return 1;
+	}
+
+	if (ac > 2)
+		triggers = atoi(av[2]);
+	if (ac > 3)
+		executors = atoi(av[3]);
+
+	if (triggers < 1 || executors < 2)
+	{
+		fputs("execstress: need at least 1 trigger and 2 executors\n", stderr);
+		return 1;
+	}
+
+	emit("namespace = \"srb2\";\n");
+
+	room = sector(0, 512, TRIGGERTAG);
+	polygon(room, 4, 0.0, 0.0, ROOMSIZE, 0, 0);
+	emit("thing { x = 0.0; y = 0.0; type = 1; }\n");
+
+	for (i = 0; i < triggers; ++i)
+	{
+		double x = 2 * ROOMSIZE + (i % CTLPERROW) * CTLSPACING;
+		double y = (i / CTLPERROW) * CTLSPACING;
+
+		/* trigger linedef, tag TRIGGERTAG, continuous (arg0 = 0) */
+		polygon(sector(0, 128, 0), executors + 1, x, y, CTLRADIUS,
+				300, TRIGGERTAG);
+	}
+
+	if (!( f = fopen(av[1], "wb") ))
+	{
+		perror(av[1]);
+		return 1;
+	}
+
+	memset(dir, 0, sizeof dir);
+
+	/* MAP01 marker, TEXTMAP, ENDMAP */
+	write_u32(&dir[0][0], 12);
+	write_u32(&dir[0][4], 0);
+	memcpy(&dir[0][8], "MAP01", 5);
+	write_u32(&dir[1][0], 12);
+	write_u32(&dir[1][4], buflen);
+	memcpy(&dir[1][8], "TEXTMAP", 7);
+	write_u32(&dir[2][0], 12 + buflen);
+	write_u32(&dir[2][4], 0);
+	memcpy(&dir[2][8], "ENDMAP", 6);
+
+	memcpy(header, "PWAD", 4);
+	write_u32(&header[4], 3);
+	write_u32(&header[8], 12 + buflen);
+
+	if (
+			fwrite(header, sizeof header, 1, f) != 1 ||
+			fwrite(buf, buflen, 1, f) != 1 ||
+			fwrite(dir, sizeof dir, 1, f) != 1
+	){
+		perror(av[1]);
+		fclose(f);
+		return 1;
+	}
+
+	fclose(f);
+
+	printf("%s: %d triggers, %d executors\n", av[1], triggers,
+			triggers * executors);
+
+	return 0;
+}
@@ -0,0 +1,53 @@
+#!/bin/sh
+# Netgame soak test launcher.
+#
+# Starts a dedicated server and a number of headless clients on this
+# machine, all running with -soaktest. The clients play with scripted
+# input; once all of them are in game, the server records the given
+# amount of tics to soaktest.csv in its home directory, prints a
+# summary and quits.
+#
+# Usage: soaktest.sh BINARY [clients] [tics] [map]
+
+if [ -z "$1" ]; then
+	echo "Usage: $0 BINARY [clients] [tics] [map]" >&2
+	exit 1
+fi
+
+BINARY=$1
+CLIENTS=${2:-4}
+TICS=${3:-10500}
+MAP=${4:-1}
+PORT=${SOAKPORT:-5129}
+HOMEDIR=${SOAKHOME:-soaktest}
+
+mkdir -p "$HOMEDIR/server"
+
+"$BINARY" -dedicated -server -port "$PORT" -warp "$MAP" \
+	-soaktest "$TICS" -soakclients "$CLIENTS" \
+	-home "$HOMEDIR/server" +joindelay 0 > "$HOMEDIR/server.log" 2>&1 &
+SERVER=$!
+
+# Give the server time to load before anyone connects
+sleep 3
+
+PIDS=
+i=1
+while [ "$i" -le "$CLIENTS" ]; do
+	mkdir -p "$HOMEDIR/client$i"
+	SDL_VIDEODRIVER=dummy SDL_AUDIODRIVER=dummy \
+	"$BINARY" -connect "127.0.0.1:$PORT" -soaktest "$TICS" -noaudio \
+		-home "$HOMEDIR/client$i" > "$HOMEDIR/client$i.log" 2>&1 &
+	PIDS="$PIDS $!"
+	i=$((i + 1))
+	sleep 1
+done
+
+wait "$SERVER"
+RESULT=$?
+
+kill $PIDS 2> /dev/null
+wait 2> /dev/null
+
+tail -n 20 "$HOMEDIR/server.log"
+exit $RESULT